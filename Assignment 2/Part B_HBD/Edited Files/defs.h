@@ -10,6 +10,10 @@ struct sleeplock;
 struct stat;
 struct superblock;
 struct processInfo;
+struct cpuInfo;
+struct schedStats;
+struct uproc;
+struct timer;
 
 // bio.c
 void            binit(void);
@@ -64,6 +68,10 @@ void            ioapicenable(int irq, int cpu);
 extern uchar    ioapicid;
 void            ioapicinit(void);
 
+// ipi.c
+#define IRQ_WAKEUP     20  // IPI that wakes a halted cpu
+void            lapicipi(int, int);
+
 // kalloc.c
 char*           kalloc(void);
 void            kfree(char*);
@@ -104,7 +112,6 @@ int             pipewrite(struct pipe*, char*, int);
 
 //PAGEBREAK: 16
 // proc.c
-extern int TimeQuanta;
 int             cpuid(void);
 void            exit(void);
 int             fork(void);
@@ -116,12 +123,16 @@ void            pinit(void);
 void            procdump(void);
 void            scheduler(void) __attribute__((noreturn));
 void            sched(void);
+int             schedtick(struct proc*);
+void            mlfqboost(void);
 void            setproc(struct proc*);
 void            sleep(void*, struct spinlock*);
 void            userinit(void);
 int             wait(void);
+int             waitinfo(struct processInfo*);
 void            wakeup(void*);
 void            yield(void);
+int             yield_to(int);
 int             thread_create(void (*)(void *), void *, void *);
 int             thread_join(void);
 void            thread_exit(void);
@@ -130,6 +141,17 @@ int             getMaxPid(void);
 int             getProcInfoStruct(int , struct processInfo *);
 int             set_burst_time(int);
 int             get_burst_time(void);
+int             get_predicted_burst(void);
+int             setnice(int, int);
+int             setscheduler(int);
+int             setaging(int);
+int             setgang(int);
+int             setrealtime(int, int, int);
+int             setaffinity(int, uint);
+void            rttick(void);
+int             getcpuinfo(int, struct cpuInfo*);
+int             getschedstats(struct schedStats*);
+int             getprocs(struct uproc*, int);
 // swtch.S
 void            swtch(struct context**, struct context*);
 
@@ -166,7 +188,9 @@ int             fetchstr(uint, char**);
 void            syscall(void);
 
 // timer.c
-void            timerinit(void);
+void            settimer(struct timer*, uint, void (*)(void*), void*);
+void            deltimer(struct timer*);
+void            runtimers(void);
 
 // trap.c
 void            idtinit(void);
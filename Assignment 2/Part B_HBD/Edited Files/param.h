@@ -1,6 +1,6 @@
-#define NPROC        64  // maximum number of processes
+#define NPROC      1024  // maximum number of processes
 #define KSTACKSIZE 4096  // size of per-process kernel stack
-#define NCPU          1  // maximum number of CPUs
+#define NCPU          8  // maximum number of CPUs
 #define NOFILE       16  // open files per process
 #define NFILE       100  // open files per system
 #define NINODE       50  // maximum number of active i-nodes
@@ -11,4 +11,19 @@
 #define LOGSIZE      (MAXOPBLOCKS*3)  // max data blocks in on-disk log
 #define NBUF         (MAXOPBLOCKS*3)  // size of disk block cache
 #define FSSIZE       1000  // size of file system in blocks
+#define QUANTUM_MIN     1  // shortest time slice, in ticks
+#define QUANTUM_MAX    32  // longest time slice, in ticks
+#define QUANTUM_DEFAULT 8  // time slice of a process with no burst time
+#define BURST_ALPHA    50  // weight (%) of the last CPU burst in the prediction
+#define MLFQ_LEVELS     4  // priority levels of the MLFQ scheduler
+#define MLFQ_BOOST    100  // ticks between MLFQ priority boosts
+#define CFS_LATENCY     8  // ticks in which every runnable process runs once (CFS)
+#define NICE_MIN      -20  // highest priority nice value
+#define NICE_MAX       19  // lowest priority nice value
+#define RT_MAXUTIL    950  // per-mille of a cpu real-time processes may reserve
+#define GANG_MAXSLICE  32  // ticks a thread may keep running while siblings run (gang mode)
+#define AGING          10  // ticks waited that count as one tick less burst (SJF, HBD), 0 for off
+#define NSLEEPQ        61  // wait channel hash buckets
+#define NPIDHASH       (NPROC/4)  // pid hash buckets, about 4 procs per chain when full
+#define SCHEDPOLICY SCHED_HBD  // scheduling policy at boot, see schedPolicy.h
 
@@ -7,25 +7,105 @@
 #include "proc.h"
 #include "spinlock.h"
 #include "processInfo.h"
-
+#include "schedPolicy.h"
+#include "schedcore.h"
+#include "cpuInfo.h"
+#include "schedStats.h"
+#include "uproc.h"
+#include "traps.h"
+
+// There is no lock over the whole table.  Each process has its own
+// lock, p->lock, which guards p->state, p->killed and p->chan and is
+// held across a switch: taken before p gives up its cpu and let go
+// by finishswitch() on the far side, so a process that is RUNNABLE
+// or SLEEPING with its lock held is fully switched out.  The other
+// locks each guard one thing:
+//  - waitlock: the parent/child lists and p->parent, so exit() and
+//    wait() do not race;
+//  - rtlock: the real-time list and the cpus' rtutil;
+//  - sleeplock[i]: sleep queue i, see sleep() and wakeup();
+//  - rqlock[i]: cpu i's run queue, see schedcore.c, and the tick
+//    accounting of the process running on cpu i;
+//  - pidlock: allocating and freeing procs: the live and free lists,
+//    nproc, nextpid and the pid index.
+// Take them in the order waitlock, rtlock, sleeplock, process locks,
+// run queue locks (in cpu order), pidlock.  A cpu holds two process
+// locks only while switching from one process to the next, the one
+// switching out first.
 struct
 {
-  struct spinlock lock;
-  struct proc proc[NPROC];
+  struct spinlock waitlock;
+  struct spinlock rtlock;
+  struct spinlock sleeplock[NSLEEPQ];
+  struct spinlock pidlock;
+  struct spinlock rqlock[NCPU];
+  struct proc *live; // every proc that is not UNUSED
+  struct proc *free; // UNUSED procs, ready for allocproc()
+  int nproc;         // length of live
+  struct proc *rt;   // real-time processes, see setrealtime()
+  struct proc *sleepq[NSLEEPQ]; // SLEEPING processes, hashed by chan
+  struct proc *pidhash[NPIDHASH]; // processes with a pid, by pid
 } ptable;
 
+// Sleep/wakeup counters, changed atomically and read without a
+// lock.
+static struct schedStats schedstats;
+
 static struct proc *initproc;
 
 int nextpid = 1;
-int TimeQuanta = 1e9;
+
 extern void forkret(void);
 extern void trapret(void);
 
-static void wakeup1(void *chan);
+static void pidremove(struct proc *p);
+static struct spinlock *sleepqlock(void *chan);
+static void wakeproc(struct proc *p, int pid, void *chan);
+static void sleepqinsert(struct proc *p);
+static void wake(struct proc *p);
+static void makerunnable(struct proc *p, int nextround);
 
 void pinit(void)
 {
-  initlock(&ptable.lock, "ptable");
+  int i;
+
+  initlock(&ptable.waitlock, "wait");
+  initlock(&ptable.rtlock, "rt");
+  for (i = 0; i < NSLEEPQ; i++)
+    initlock(&ptable.sleeplock[i], "sleepq");
+  initlock(&ptable.pidlock, "pid");
+  for (i = 0; i < NCPU; i++)
+    initlock(&ptable.rqlock[i], "runq");
+}
+
+void rqlock(struct cpu *c)
+{
+  acquire(&ptable.rqlock[c - cpus]);
+}
+
+void rqunlock(struct cpu *c)
+{
+  release(&ptable.rqlock[c - cpus]);
+}
+
+// Lock every run queue, in cpu order, to change how they are all
+// keyed.
+static void
+rqlockall(void)
+{
+  int i;
+
+  for (i = 0; i < ncpu; i++)
+    rqlock(&cpus[i]);
+}
+
+static void
+rqunlockall(void)
+{
+  int i;
+
+  for (i = 0; i < ncpu; i++)
+    rqunlock(&cpus[i]);
 }
 
 // Must be called with interrupts disabled
@@ -69,9 +149,224 @@ myproc(void)
   return p;
 }
 
+// struct procs are carved out of pages from kalloc() as they are
+// needed, up to NPROC of them, and kept on a free list once reaped.
+// Each one's lock is carved from the end of the same page; proc.h
+// cannot hold a struct spinlock itself, as not every file that
+// includes it includes spinlock.h first.
+// Everything that is not UNUSED is on the live list, which is what
+// code that wants to look at every process walks.  It is in order of
+// allocation, newest first, so the first process has the highest
+// pid (see getMaxPid()).  pidlock must be held.
+static struct proc *
+procalloc(void)
+{
+  struct proc *p;
+  struct spinlock *locks;
+  char *page;
+  int i, n;
+
+  if (ptable.nproc >= NPROC)
+    return 0;
+  if (ptable.free == 0)
+  {
+    if ((page = kalloc()) == 0)
+      return 0;
+    memset(page, 0, PGSIZE);
+    n = PGSIZE / (sizeof(struct proc) + sizeof(struct spinlock));
+    locks = (struct spinlock *)(page + n * sizeof(struct proc));
+    for (i = 0; i < n; i++)
+    {
+      p = (struct proc *)page + i;
+      p->lock = &locks[i];
+      initlock(p->lock, "proc");
+      p->livenext = ptable.free;
+      ptable.free = p;
+    }
+  }
+  p = ptable.free;
+  ptable.free = p->livenext;
+
+  p->pid = nextpid++;
+  p->liveprev = 0;
+  p->livenext = ptable.live;
+  if (ptable.live)
+    ptable.live->liveprev = p;
+  __sync_synchronize(); // pid set before p is seen as the first
+  ptable.live = p;
+  ptable.nproc++;
+  return p;
+}
+
+// Take p out of the pid index, mark it UNUSED and give it back to
+// the free list.  p->lock and pidlock must both be held, so that a
+// process found with either one held is not freed under the finder
+// (see lockproc()).
+static void
+procfree(struct proc *p)
+{
+  pidremove(p);
+  if (p->liveprev)
+    p->liveprev->livenext = p->livenext;
+  else
+    ptable.live = p->livenext;
+  if (p->livenext)
+    p->livenext->liveprev = p->liveprev;
+  ptable.nproc--;
+
+  p->parent = 0;
+  p->name[0] = 0;
+  p->killed = 0;
+  p->state = UNUSED;
+  p->liveprev = 0;
+  p->livenext = ptable.free;
+  ptable.free = p;
+}
+
+// Pid index, so that looking up a process by pid does not scan
+// the whole table.  A process is in it from allocproc() until it
+// is reaped.  pidlock must be held.
+static void
+pidinsert(struct proc *p)
+{
+  struct proc **head = &ptable.pidhash[p->pid % NPIDHASH];
+
+  p->pidnext = *head;
+  *head = p;
+}
+
+static void
+pidremove(struct proc *p)
+{
+  struct proc **pp = &ptable.pidhash[p->pid % NPIDHASH];
+
+  while (*pp != p)
+    pp = &(*pp)->pidnext;
+  *pp = p->pidnext;
+  p->pidnext = 0;
+}
+
+// The process with the given pid, or 0 if there is none.
+static struct proc *
+pidlookup(int pid)
+{
+  struct proc *p;
+
+  if (pid <= 0)
+    return 0;
+  for (p = ptable.pidhash[pid % NPIDHASH]; p; p = p->pidnext)
+    if (p->pid == pid)
+      return p;
+  return 0;
+}
+
+// The process with the given pid, with its lock held, or 0 if
+// there is none.  procfree() needs that lock too, so the process
+// stays allocated, with the same pid, until the caller releases it.
+// The lookup itself needs pidlock, which comes after process locks,
+// so p is locked only after pidlock is let go and then checked
+// again in case it was freed and reused in between.  procs are never
+// given back to kalloc(), so p can still be looked at.
+static struct proc *
+lockproc(int pid)
+{
+  struct proc *p;
+
+  acquire(&ptable.pidlock);
+  p = pidlookup(pid);
+  release(&ptable.pidlock);
+  if (p == 0)
+    return 0;
+  acquire(p->lock);
+  if (p->pid != pid || p->state == UNUSED)
+  {
+    release(p->lock);
+    return 0;
+  }
+  return p;
+}
+
+// Every process is on its parent's children list until it exits,
+// and on the parent's zombies list from then until it is reaped, so
+// wait() and exit() only look at the processes they care about.
+// waitlock must be held.
+static void
+childlink(struct proc **head, struct proc *p)
+{
+  p->sibling = *head;
+  if (p->sibling)
+    p->sibling->psibling = &p->sibling;
+  *head = p;
+  p->psibling = head;
+}
+
+static void
+childunlink(struct proc *p)
+{
+  if (p->psibling == 0)
+    return;
+  *p->psibling = p->sibling;
+  if (p->sibling)
+    p->sibling->psibling = p->psibling;
+  p->sibling = 0;
+  p->psibling = 0;
+}
+
+// Move every process on list *from to list *to, with parent np.
+static void
+childsplice(struct proc **from, struct proc **to, struct proc *np)
+{
+  struct proc *p;
+
+  while ((p = *from) != 0)
+  {
+    childunlink(p);
+    p->parent = np;
+    childlink(to, p);
+  }
+}
+
+// Take p out of the real-time class, giving back its share of
+// its cpu.  rtlock must be held.
+static void
+rtleave(struct proc *p)
+{
+  struct proc **pp;
+
+  if (p->rtRuntime == 0)
+    return;
+  for (pp = &ptable.rt; *pp != p; pp = &(*pp)->rtnext)
+    ;
+  *pp = p->rtnext;
+  cpus[p->cpu].rtutil -= p->rtUtil;
+  p->rtRuntime = 0;
+}
+
+// Pass the children of exiting process p to init, then put p on
+// its parent's zombies list.  p leaves the real-time class too.
+// waitlock must be held.
+static void
+reparent(struct proc *p)
+{
+  if (p->rtRuntime)
+  {
+    acquire(&ptable.rtlock);
+    rtleave(p);
+    release(&ptable.rtlock);
+  }
+  childsplice(&p->children, &initproc->children, initproc);
+  if (p->zombies)
+  {
+    childsplice(&p->zombies, &initproc->zombies, initproc);
+    wakeup(initproc);
+  }
+  childunlink(p);
+  childlink(&p->parent->zombies, p);
+}
+
 // PAGEBREAK: 32
-//  Look in the process table for an UNUSED proc.
-//  If found, change state to EMBRYO and initialize
+//  Allocate a proc.
+//  If there is room, change state to EMBRYO and initialize
 //  state required to run in the kernel.
 //  Otherwise return 0.
 static struct proc *
@@ -80,27 +375,55 @@ allocproc(void)
   struct proc *p;
   char *sp;
 
-  acquire(&ptable.lock);
+  acquire(&ptable.pidlock);
 
-  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-    if (p->state == UNUSED)
-      goto found;
-
-  release(&ptable.lock);
-  return 0;
+  if ((p = procalloc()) == 0)
+  {
+    release(&ptable.pidlock);
+    return 0;
+  }
 
-found:
   p->state = EMBRYO;
-  p->pid = nextpid++;
+  pidinsert(p);
+  p->children = p->zombies = 0;
+  p->sibling = 0;
+  p->psibling = 0;
+  p->is_thread = 0;
   p->numContextSwitches = 0;
   p->burstTime = 0;
+  p->predBurst = 0;
+  p->burstTicks = 0;
+  p->mlfqLevel = 0;
+  p->nice = 0;
+  p->vruntime = 0;
+  p->rtRuntime = 0;
+  p->quantum = QUANTUM_DEFAULT;
+  p->time_slice = 0;
   p->first_proc = 0;
-  release(&ptable.lock);
+  p->alreadyRun = 0;
+  p->rqidx = -1;
+  p->cpu = -1;
+  p->affinity = ~0;
+  p->migrations = 0;
+  p->ingang = 0;
+  p->gangboost = 0;
+  p->woken = 0;
+  p->utime = p->stime = p->waitTicks = 0;
+  p->maxWait = 0;
+  p->ctime = ticks;
+  p->etime = 0;
+  p->nvcsw = p->nivcsw = 0;
+  p->pageFaults = 0;
+  release(&ptable.pidlock);
 
   // Allocate kernel stack.
   if ((p->kstack = kalloc()) == 0)
   {
-    p->state = UNUSED;
+    acquire(p->lock);
+    acquire(&ptable.pidlock);
+    procfree(p);
+    release(&ptable.pidlock);
+    release(p->lock);
     return 0;
   }
   sp = p->kstack + KSTACKSIZE;
@@ -152,11 +475,11 @@ void userinit(void)
   // run this process. the acquire forces the above
   // writes to be visible, and the lock is also needed
   // because the assignment might not be atomic.
-  acquire(&ptable.lock);
+  acquire(p->lock);
 
-  p->state = RUNNABLE;
+  makerunnable(p, 0);
 
-  release(&ptable.lock);
+  release(p->lock);
 }
 
 // Grow current process's memory by n bytes.
@@ -202,11 +525,19 @@ int fork(void)
   {
     kfree(np->kstack);
     np->kstack = 0;
-    np->state = UNUSED;
+    acquire(np->lock);
+    acquire(&ptable.pidlock);
+    procfree(np);
+    release(&ptable.pidlock);
+    release(np->lock);
     return -1;
   }
   np->sz = curproc->sz;
   np->parent = curproc;
+  np->predBurst = curproc->predBurst;
+  np->nice = curproc->nice;
+  np->vruntime = curproc->vruntime;
+  np->affinity = curproc->affinity;
   *np->tf = *curproc->tf;
 
   // Clear %eax so that fork returns 0 in the child.
@@ -221,11 +552,13 @@ int fork(void)
 
   pid = np->pid;
 
-  acquire(&ptable.lock);
-
-  np->state = RUNNABLE;
+  acquire(&ptable.waitlock);
+  childlink(&curproc->children, np);
+  release(&ptable.waitlock);
 
-  release(&ptable.lock);
+  acquire(np->lock);
+  makerunnable(np, 0);
+  release(np->lock);
 
   return pid;
 }
@@ -236,7 +569,6 @@ int fork(void)
 void exit(void)
 {
   struct proc *curproc = myproc();
-  struct proc *p;
   int fd;
 
   if (curproc == initproc)
@@ -257,325 +589,685 @@ void exit(void)
   end_op();
   curproc->cwd = 0;
 
-  acquire(&ptable.lock);
+  acquire(&ptable.waitlock);
 
   // Parent might be sleeping in wait().
-  wakeup1(curproc->parent);
+  wakeup(curproc->parent);
 
   // Pass abandoned children to init.
-  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-  {
-    if (p->parent == curproc)
-    {
-      p->parent = initproc;
-      if (p->state == ZOMBIE)
-        wakeup1(initproc);
-    }
-  }
+  reparent(curproc);
 
-  // Jump into the scheduler, never to return.
+  // Jump into the scheduler, never to return.  Once waitlock is
+  // let go the parent may find us, but it cannot free us before
+  // the switch is over, as that needs our lock.
+  acquire(curproc->lock);
+  curproc->etime = ticks;
   curproc->state = ZOMBIE;
+  release(&ptable.waitlock);
   sched();
   panic("zombie exit");
 }
 
+// Fill in *info from p.  The caller holds pidlock, as
+// getProcInfoStruct() does, or p->lock, as waitinfo() does;
+// procfree() needs both, so either keeps p from being freed.
+// p->parent may have exited and been freed meanwhile, but proc
+// pages are never given back to kalloc(), so reading its pid is
+// safe even if the ppid reported is stale.
+static void
+procinfo(struct proc *p, struct processInfo *info)
+{
+  info->ppid = p->parent ? p->parent->pid : 0;
+  info->psize = p->sz;
+  info->numberContextSwitches = p->numContextSwitches;
+  info->burstTime = p->burstTime;
+  info->userTicks = p->utime;
+  info->sysTicks = p->stime;
+  info->waitTicks = p->waitTicks;
+  info->maxWaitTicks = p->maxWait;
+  info->creationTime = p->ctime;
+  info->exitTime = p->etime;
+  info->firstRunTime = p->alreadyRun ? p->firstRun : 0;
+  info->voluntarySwitches = p->nvcsw;
+  info->involuntarySwitches = p->nivcsw;
+  info->pageFaults = p->pageFaults;
+  info->migrations = p->migrations;
+}
+
 // Wait for a child process to exit and return its pid.
 // Return -1 if this process has no children.
 int wait(void)
+{
+  return waitinfo(0);
+}
+
+// Like wait(), but also report the resource usage of the child
+// in *info unless info is 0.
+int waitinfo(struct processInfo *info)
 {
   struct proc *p;
   int havekids, pid;
   struct proc *curproc = myproc();
 
-  acquire(&ptable.lock);
+  acquire(&ptable.waitlock);
   for (;;)
   {
-    // Scan through table looking for exited children.
-    havekids = 0;
-    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    // Reap the first exited child, if any.
+    havekids = curproc->children || curproc->zombies;
+    if ((p = curproc->zombies) != 0)
     {
-      if (p->parent != curproc)
-        continue;
-      havekids = 1;
-      if (p->state == ZOMBIE)
-      {
-        // Found one.
-        pid = p->pid;
-        kfree(p->kstack);
-        p->kstack = 0;
-        freevm(p->pgdir);
-        p->pid = 0;
-        p->parent = 0;
-        p->name[0] = 0;
-        p->killed = 0;
-        p->state = UNUSED;
-        release(&ptable.lock);
-        return pid;
-      }
+      // Found one.  Its lock is held until it has switched off its
+      // stack for the last time.
+      pid = p->pid;
+      childunlink(p);
+      release(&ptable.waitlock);
+      acquire(p->lock);
+      if (info)
+        procinfo(p, info);
+      kfree(p->kstack);
+      p->kstack = 0;
+      freevm(p->pgdir);
+      acquire(&ptable.pidlock);
+      procfree(p);
+      release(&ptable.pidlock);
+      release(p->lock);
+      return pid;
     }
 
     // No point waiting if we don't have any children.
     if (!havekids || curproc->killed)
     {
-      release(&ptable.lock);
+      release(&ptable.waitlock);
       return -1;
     }
 
-    // Wait for children to exit.  (See wakeup1 call in proc_exit.)
-    sleep(curproc, &ptable.lock); // DOC: wait-sleep
+    // Wait for children to exit.  (See wakeup call in proc_exit.)
+    sleep(curproc, &ptable.waitlock); // DOC: wait-sleep
   }
 }
 
-// hybride scheduling
-void merge(struct proc *RQ[], int l, int m, int r)
+// The run queues and policies themselves are in schedcore.c; what
+// is left here wakes up cpus to run what was queued.
+
+// Is there anything c could run?  Reads the queues without the
+// lock, which is good enough for deciding to halt.
+static int
+anyrunnable(struct cpu *c)
+{
+  int i;
+
+  return c->rq.n > 0 || stealfrom(c, &i) != 0;
+}
+
+// Work p was just queued on c.  If c is halted, wake it up; if c is
+// busy, wake some other halted CPU that may steal p.
+static void
+kickcpu(struct cpu *c, struct proc *p)
+{
+  int i;
+
+  for (i = 0; !c->idle && i < ncpu; i++)
+    if (cpus[i].idle && canmove(p, &cpus[i]))
+      c = &cpus[i];
+  if (!c->idle || c == mycpu())
+    return;
+  c->idle = 0;
+  lapicipi(c->apicid, T_IRQ0 + IRQ_WAKEUP);
+}
+
+// Mark p RUNNABLE and put it on its CPU's ready queue, keyed by
+// the current policy.  p->lock must be held and p switched out.
+static void
+makerunnable(struct proc *p, int nextround)
+{
+  p->state = RUNNABLE;
+  kickcpu(rqenqueue(p, nextround), p);
+}
+
+// p, running on this cpu, is giving it up but wants to run again.
+// It can go on this cpu's own queue at once: no other cpu takes it
+// from there while it is still switching out (see canmove()), and
+// this cpu is the one switching it.  Any other cpu's queue has to
+// wait until the switch is over, which finishswitch() sees to.
+// p->lock must be held.
+static void
+requeue(struct proc *p)
 {
-  int i, j, k;
-  int n1 = m - l + 1;
-  int n2 = r - m;
+  struct cpu *c = mycpu();
 
-  /* create temp RQays */
-  struct proc *L[n1], *R[n2];
+  p->state = RUNNABLE;
+  if (rqhome(p) == c)
+    rqenqueueon(p, c, 1);
+  else
+    c->requeue = 1;
+}
 
-  /* Copy data to temp RQays L[] and R[] */
-  for (i = 0; i < n1; i++)
-    L[i] = RQ[l + i];
-  for (j = 0; j < n2; j++)
-    R[j] = RQ[m + 1 + j];
+// Take p, RUNNABLE and locked, off the run queue it is on.  Other
+// cpus may move it between queues without its lock, so look again
+// once the queue is locked.  Returns 0 if it is on none, having
+// been picked to run.
+static int
+rqtake(struct proc *p)
+{
+  struct cpu *c;
 
-  /* Merge the temp RQays back into RQ[l..r]*/
-  i = 0; // Initial index of first subRQay
-  j = 0; // Initial index of second subRQay
-  k = l; // Initial index of merged subRQay
-  while (i < n1 && j < n2)
+  while (p->rqidx >= 0)
   {
-    if (L[i]->burstTime <= R[j]->burstTime)
+    c = &cpus[p->rqcpu];
+    rqlock(c);
+    if (p->rqidx >= 0 && p->rqcpu == c - cpus)
     {
-      RQ[k] = L[i];
-      i++;
+      rqremove(&c->rq, p->rqidx);
+      rqunlock(c);
+      return 1;
     }
-    else
+    rqunlock(c);
+  }
+  return 0;
+}
+
+// Lock the run queues of c and d, in cpu order.
+static void
+rqlockpair(struct cpu *c, struct cpu *d)
+{
+  if (c > d)
+    rqlockpair(d, c);
+  else
+  {
+    rqlock(c);
+    if (d != c)
+      rqlock(d);
+  }
+}
+
+static void
+rqunlockpair(struct cpu *c, struct cpu *d)
+{
+  rqunlock(c);
+  if (d != c)
+    rqunlock(d);
+}
+
+// Gang scheduling: run the threads of an address space at the same
+// time on different cpus, so that a thread spinning on a lock is not
+// waiting for a sibling that holds it but is not running.
+static int gang;
+
+// Is a sibling of p running on some other cpu?  Reads the cpus
+// without the lock; a stale answer only costs a tick.
+static int
+siblingrunning(struct proc *p)
+{
+  struct proc *q;
+  int i;
+
+  for (i = 0; i < ncpu; i++)
+    if ((q = cpus[i].proc) != 0 && q != p && q->pgdir == p->pgdir)
+      return 1;
+  return 0;
+}
+
+// p, one of a group of threads, is being dispatched on c.  Move a
+// runnable sibling to the front of the queue of every other cpu that
+// is not already running one, and kick it if it is idle; a busy cpu
+// gives way on its next tick (see schedtick()).  Each queue is
+// searched with its lock and d's held, so the sibling found is
+// still there to move.
+static void
+gangpull(struct proc *p, struct cpu *c)
+{
+  struct cpu *d, *e;
+  struct runq *rq;
+  struct proc *q;
+  int j;
+
+  for (d = cpus; d < cpus + ncpu; d++)
+  {
+    if (d == c || (d->proc && d->proc->pgdir == p->pgdir))
+      continue;
+    if (d->rq.n > 0 && d->rq.heap[0]->gangboost && d->rq.heap[0]->pgdir == p->pgdir)
+      continue;
+    for (q = 0, e = cpus; q == 0 && e < cpus + ncpu; e++)
     {
-      RQ[k] = R[j];
-      j++;
+      rq = &e->rq;
+      rqlockpair(d, e);
+      for (j = 0; j < rq->n; j++)
+        if (rq->heap[j]->pgdir == p->pgdir && !rq->heap[j]->gangboost &&
+            (e == d || canmove(rq->heap[j], d)))
+        {
+          q = rq->heap[j];
+          rqremove(rq, j);
+          q->gangboost = 1;
+          q->rqcpu = d - cpus;
+          rqpush(&d->rq, q);
+          break;
+        }
+      rqunlockpair(d, e);
     }
-    k++;
-  }
-
-  /* Copy the remaining elements of L[], if there
-  are any */
-  while (i < n1)
-  {
-    RQ[k] = L[i];
-    i++;
-    k++;
-  }
-
-  /* Copy the remaining elements of R[], if there
-  are any */
-  while (j < n2)
-  {
-    RQ[k] = R[j];
-    j++;
-    k++;
-  }
-}
-
-/* l is for left index and r is right index of the
-sub-RQay of RQ to be sorted */
-void mergeSort(struct proc *RQ[], int l, int r)
-{
-  if (l < r)
-  {
-    // Same as (l+r)/2, but avoids overflow for
-    // large l and h
-    int m = l + (r - l) / 2;
-
-    // Sort first and second halves
-    mergeSort(RQ, l, m);
-    mergeSort(RQ, m + 1, r);
-
-    merge(RQ, l, m, r);
-  }
-}
-
-// Default Scheduling
-// void scheduler(void)
-// {
-//   struct proc *p;
-//   struct cpu *c = mycpu();
-//   c->proc = 0;
-
-//   for (;;)
-//   {
-//     // Enable interrupts on this processor.
-//     sti();
-
-//     // Loop over process table looking for process to run.
-//     acquire(&ptable.lock);
-//     for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-//     {
-//       if (p->state != RUNNABLE)
-//         continue;
-
-//       // Switch to chosen process.  It is the process's job
-//       // to release ptable.lock and then reacquire it
-//       // before jumping back to us.
-//       // (p->conte)++;
-//       c->proc = p;
-//       switchuvm(p);
-//       p->state = RUNNING;
-//       p->numContextSwitches += 1;
-//       swtch(&(c->scheduler), p->context);
-//       switchkvm();
-
-//       // Process is done running for now.
-//       // It should have changed its p->state before coming back.
-//       c->proc = 0;
-//     }
-//     release(&ptable.lock);
-//   }
-// }
-
-// void getlowestBTprocess(struct proc *p1,struct proc **lowestBT)
-// {
-//   for (p1 = ptable.proc; p1 < &ptable.proc[NPROC]; p1++)
-//   {
-//     if (p1->state == RUNNABLE && p1->burstTime < (*lowestBT)->burstTime)
-//       (*lowestBT) = p1;
-//   }
-// }
-
-// // SJF Scheduling
-// void scheduler(void)
-// {
-//   struct proc *p;
-//   struct cpu *c = mycpu();
-//   c->proc = 0;
-//   for (;;)
-//   {
-//     sti();
-//     acquire(&ptable.lock);
-//     for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-//     {
-//       if (p->state != RUNNABLE)
-//         continue;
-
-//       // if doing shortest job first scheduling
-//       struct proc *lowestBT = p; // stores the lowest burst time
-//       struct proc *p1 = 0;       // act as loop variable
-//       getlowestBTprocess(p1,&lowestBT);
-//       p = lowestBT;
-
-//       // Switch to chosen process.  It is the process's job
-//       // to release ptable.lock and then reacquire it
-//       // before jumping back to us.
-//       c->proc = p;
-//       switchuvm(p);
-//       p->state = RUNNING;
-//       p->alreadyRun = 1;
-//       swtch(&(c->scheduler), p->context);
-//       p->numContextSwitches = p->numContextSwitches + 1;
-
-//       switchkvm();
-
-//       // Process is done running for now.
-//       // It should have changed its p->state before coming back.
-//       c->proc = 0;
-//     }
-//     release(&ptable.lock);
-//   }
-// }
-// Hybrid
+    if (q == 0)
+      return;
+    if (d->idle)
+      kickcpu(d, q);
+  }
+}
+
+// Called on every timer tick for the process running on this cpu.
+// Returns 1 when it should yield: a real-time process with an
+// earlier deadline is waiting, a real-time process ran out of
+// budget, or the policy says the time quanta is up.  Needs only
+// this cpu's run queue lock.
+int schedtick(struct proc *p)
+{
+  struct cpu *c = mycpu();
+  struct proc *q;
+  int preempt;
+
+  rqlock(c);
+  p->time_slice += 1;
+  q = c->rq.n > 0 ? c->rq.heap[0] : 0;
+  if (p->rtRuntime)
+  {
+    p->rtBudget--;
+    preempt = p->rtBudget <= 0 ||
+              (q && q->rtRuntime && (int)(q->rtDeadlineAt - p->rtDeadlineAt) < 0);
+  }
+  else if (q && q->rtRuntime)
+    preempt = 1;
+  // Make way for a thread whose siblings are running, but do not
+  // stop a thread while its own siblings run, for a while.
+  else if (gang && q && q->gangboost && q->pgdir != p->pgdir)
+    preempt = 1;
+  else if (gang && p->ingang && p->time_slice < GANG_MAXSLICE && siblingrunning(p))
+    preempt = 0;
+  else
+    preempt = policytick(p);
+  rqunlock(c);
+  return preempt;
+}
+
+// Queue every waiting process again under the current policy.
+// Every run queue lock must be held (see rqlockall()).
+static void
+rekey(void)
+{
+  struct runq *rq;
+  int i, j;
+
+  for (i = 0; i < ncpu; i++)
+  {
+    rq = &cpus[i].rq;
+    for (j = 0; j < rq->n; j++)
+    {
+      rq->heap[j]->rqround = rq->round;
+      setkey(rq, rq->heap[j], 0);
+    }
+    rqheapify(rq);
+  }
+}
+
+// Switch to scheduling policy n on the fly.  Every queued process
+// is re-keyed by the new policy.  Returns the previous policy, or
+// -1 if n is not a policy built into this kernel.
+int setscheduler(int n)
+{
+  int old;
+
+  if (n < 0 || n >= NSCHED || schedclasses[n].name == 0)
+    return -1;
+
+  rqlockall();
+  old = schedpolicy;
+#ifndef SCHEDONLY
+  schedpolicy = n;
+  rekey();
+#endif
+  rqunlockall();
+  return old;
+}
+
+// Turn gang scheduling of threads on or off.  Returns the previous
+// setting.
+int setgang(int on)
+{
+  int old;
+
+  rqlockall();
+  old = gang;
+  gang = on != 0;
+  rqunlockall();
+  return old;
+}
+
+// Set the aging rate of SJF and HBD, see sjfkey().  Returns the
+// previous rate, or -1 if n is negative.
+int setaging(int n)
+{
+  int old;
+
+  if (n < 0)
+    return -1;
+
+  rqlockall();
+  old = aging;
+  aging = n;
+  rekey();
+  rqunlockall();
+  return old;
+}
+
+// Periodic MLFQ priority boost: move every process back to the top
+// level so that CPU hogs are not starved by a stream of
+// interactive jobs.  Called from the timer interrupt on cpu 0.
+void mlfqboost(void)
+{
+  struct proc *p;
+  int i;
+
+  if (schedpolicy != SCHED_MLFQ)
+    return;
+
+  // Running processes are raised too, so every run queue lock is
+  // needed to keep their own ticks out.
+  rqlockall();
+  acquire(&ptable.pidlock);
+  for (p = ptable.live; p; p = p->livenext)
+    mlfqraise(p);
+  release(&ptable.pidlock);
+  for (i = 0; i < ncpu; i++)
+    rqheapify(&cpus[i].rq);
+  rqunlockall();
+}
+
+// Start a new period for every real-time process whose period is
+// over: refill its budget, move its deadline on, and let it run
+// again if it was throttled.  Called from the timer interrupt on
+// cpu 0.
+void rttick(void)
+{
+  struct proc *p;
+
+  if (ptable.rt == 0)
+    return;
+
+  acquire(&ptable.rtlock);
+  for (p = ptable.rt; p; p = p->rtnext)
+  {
+    if (ticks - p->rtStart < p->rtPeriod)
+      continue;
+    // A real-time process only ever runs and queues on p->cpu.
+    rqlock(&cpus[p->cpu]);
+    p->rtStart = ticks;
+    p->rtBudget = p->rtRuntime;
+    p->rtDeadlineAt = ticks + p->rtDeadline;
+    if (p->rqidx >= 0)
+    {
+      p->rqkey = p->rtDeadlineAt;
+      rqdown(&cpus[p->cpu].rq, p->rqidx);
+    }
+    rqunlock(&cpus[p->cpu]);
+    // yield() checks the budget under the same sleep queue lock,
+    // so it either sees the refill or is asleep by now.
+    wakeproc(p, p->pid, &p->rtBudget);
+  }
+  release(&ptable.rtlock);
+}
+
+// The process c should run next, or 0 if there is none.  Sets
+// *slice to the part of its time quanta it has used already.
+// Interrupts must be off.
+static struct proc *
+pickproc(struct cpu *c, int *slice)
+{
+  struct proc *p;
+
+  *slice = 0;
+  if ((p = c->handoff) != 0)
+  {
+    // Directed yield: run the process yield_to() picked, for
+    // what is left of the quanta it was given.
+    c->handoff = 0;
+    *slice = c->handoffslice;
+    return p;
+  }
+  return picknext(c);
+}
+
+// Make p, just picked by pickproc(), the process running on c.
+// The caller holds p->lock and switches to its address space and
+// context.
+static void
+runproc(struct proc *p, struct cpu *c, int slice)
+{
+  dispatch(p, c, slice);
+  p->oncpu = 1;
+  if (gang && p->ingang)
+    gangpull(p, c);
+  c->proc = p;
+  if (p->woken)
+  {
+    __sync_fetch_and_add(&schedstats.wakeLatency, ticks - p->wakeTick);
+    __sync_fetch_and_add(&schedstats.wokenRun, 1);
+    p->woken = 0;
+  }
+}
+
+// Called on the far side of a switch, on the stack switched to,
+// to finish with the process switched out (c->prev): now that it
+// is off its stack it may run on any cpu, so queue it if requeue()
+// left that to us, or kick an idle cpu to steal it if it is
+// waiting here, and let go of its lock.
+static void
+finishswitch(void)
+{
+  struct cpu *c = mycpu();
+  struct proc *p = c->prev;
+
+  if (p == 0)
+    return;
+  c->prev = 0;
+  p->oncpu = 0;
+  if (c->requeue)
+  {
+    c->requeue = 0;
+    makerunnable(p, 1);
+  }
+  else if (p->state == RUNNABLE && p->rqidx >= 0)
+    kickcpu(c, p);
+  release(p->lock);
+}
+
+// Per-CPU process scheduler.
+// Each CPU calls scheduler() after setting itself up.
+// Scheduler never returns.  It loops, doing:
+//  - ask the scheduling policy for the next process,
+//    normally the head of this CPU's run queue
+//  - swtch to start running that process
+//  - eventually that process, or the last of the ones it
+//    switched to directly (see sched()), finds nothing to run
+//    and transfers control via swtch back to the scheduler.
 void scheduler(void)
 {
   struct proc *p;
   struct cpu *c = mycpu();
+  int slice;
   c->proc = 0;
-  // int flag = 1;
   for (;;)
   {
     // Enable interrupts on this processor.
     sti();
 
-    acquire(&ptable.lock);
-
-    // Set up Ready Queue
-    struct proc *RQ[NPROC];
-
-    int k = 0;
-
-    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    pushcli();
+    if ((p = pickproc(c, &slice)) == 0)
     {
-      if (p->state == RUNNABLE)
+      // Nothing to run.  Say so, then look at the queues once
+      // more, so that whoever queues work in between either is
+      // seen here or sees idle and sends a wakeup IPI.  Halt
+      // until that or some other interrupt arrives; sti; hlt
+      // cannot lose an interrupt in between.
+      c->idle = 1;
+      popcli();
+      cli();
+      __sync_synchronize();
+      if (c->idle && !anyrunnable(c))
       {
-        RQ[k++] = p;
+        c->halts++;
+        asm volatile("sti; hlt");
       }
+      c->idle = 0;
+      continue;
     }
-    // struct proc *t;
-    // Sort Ready Queue
-    mergeSort(RQ,0,k-1);
 
-    // Find the job with least burstTime time
-    for (int i = 0; i < k; i++)
-    {
-      p = RQ[i];
-      if (p->state == RUNNABLE)
-      {
-        // cprintf("BT %d \n", i);
-        // Switch to chosen process.  It is the process's job
-        // to release ptable.lock and then reacquire it
-        // before jumping back to us.
-        c->proc = p;
-        switchuvm(p);
-        p->state = RUNNING;
-
-        swtch(&(c->scheduler), p->context);
-
-        // increment number of context switches
-        p->numContextSwitches = p->numContextSwitches + 1;
-        switchkvm();
-
-        // Process is done running for now.
-        // It should have changed its p->state before coming back.
-        c->proc = 0;
-      }
-    }
-    release(&ptable.lock);
+    // Switch to chosen process.  It is the process's job
+    // to release its lock and then reacquire it
+    // before jumping back to us.
+    acquire(p->lock);
+    popcli();
+    runproc(p, c, slice);
+    switchuvm(p);
+    swtch(&(c->scheduler), p->context);
+    switchkvm();
+
+    // The process, or the last of the ones it switched to
+    // directly (see sched()), is done running for now.
+    // It should have changed its p->state before coming back.
+    c->proc = 0;
+    finishswitch();
   }
 }
 
-// Enter scheduler.  Must hold only ptable.lock
+// Enter scheduler.  Must hold only p->lock
 // and have changed proc->state. Saves and restores
 // intena because intena is a property of this
 // kernel thread, not this CPU. It should
 // be proc->intena and proc->ncli, but that would
 // break in the few places where a lock is held but
 // there's no process.
+// If there is another process to run, switch straight to it rather
+// than through the scheduler loop: one swtch() and one page table
+// load instead of two each, and none at all if p itself is next.
+// The scheduler loop is only entered to idle.  Switching straight
+// to q takes q's lock too; whichever side of a switch we come back
+// on, finishswitch() lets go of the one switched out.
 void sched(void)
 {
-  int intena;
+  int intena, slice;
   struct proc *p = myproc();
+  struct cpu *c;
+  struct proc *q;
 
-  if (!holding(&ptable.lock))
-    panic("sched ptable.lock");
+  if (!holding(p->lock))
+    panic("sched p->lock");
   if (mycpu()->ncli != 1)
     panic("sched locks");
   if (p->state == RUNNING)
     panic("sched running");
   if (readeflags() & FL_IF)
     panic("sched interruptible");
-  intena = mycpu()->intena;
-  swtch(&p->context, mycpu()->scheduler);
+  c = mycpu();
+  intena = c->intena;
+  if ((q = pickproc(c, &slice)) == p)
+    runproc(p, c, slice);
+  else
+  {
+    p->numContextSwitches++;
+    c->prev = p;
+    if (q == 0)
+      swtch(&p->context, c->scheduler);
+    else
+    {
+      acquire(q->lock);
+      runproc(q, c, slice);
+      switchuvm(q);
+      swtch(&p->context, q->context);
+    }
+    finishswitch();
+  }
   mycpu()->intena = intena;
 }
 
+// Charge p, running on this cpu, for the ticks it has run; see
+// chargeburst().  This cpu's run queue lock keeps mlfqboost() and
+// the timer tick out.
+static void
+chargeself(struct proc *p, int blocked)
+{
+  struct cpu *c = mycpu();
+
+  rqlock(c);
+  chargeburst(p, blocked);
+  rqunlock(c);
+}
+
 // Give up the CPU for one scheduling round.
 void yield(void)
 {
-  acquire(&ptable.lock); // DOC: yieldlock
-  myproc()->state = RUNNABLE;
+  struct proc *p = myproc();
+  struct spinlock *lk = 0;
+
+  // A real-time process may be out of budget.  Look under the
+  // sleep queue lock rttick() takes to wake it, so that a refill
+  // is not missed.
+  if (p->rtRuntime)
+  {
+    lk = sleepqlock(&p->rtBudget);
+    acquire(lk);
+  }
+  acquire(p->lock); // DOC: yieldlock
+  p->nivcsw++;
+  chargeself(p, 0);
+  if (p->rtRuntime && p->rtBudget <= 0)
+  {
+    // Out of budget: throttled until rttick() starts its next
+    // period.
+    p->chan = &p->rtBudget;
+    p->state = SLEEPING;
+    sleepqinsert(p);
+    release(lk);
+    sched();
+    p->chan = 0;
+  }
+  else
+  {
+    if (lk)
+      release(lk);
+    requeue(p);
+    sched();
+  }
+  release(p->lock);
+}
+
+// Give the rest of the caller's time quanta to process pid, which
+// runs next on this cpu without going through the run queue.  Meant
+// for a thread waiting on a lock whose holder is not running.
+// Returns -1, without yielding, if pid is not waiting for a cpu or
+// may not run on this one.
+int yield_to(int pid)
+{
+  struct proc *curproc = myproc();
+  struct proc *p;
+  struct cpu *c;
+
+  if ((p = lockproc(pid)) == 0)
+    return -1;
+  c = mycpu();
+  if (p->state != RUNNABLE || !(canmove(p, c) || p->rqcpu == c - cpus) ||
+      !rqtake(p))
+  {
+    release(p->lock);
+    return -1;
+  }
+  // p is on no queue now, so nothing else will run it; it is
+  // RUNNING curproc, not p, that has to be locked to switch.
+  acquire(curproc->lock);
+  c->handoff = p;
+  c->handoffslice = curproc->time_slice;
+  release(p->lock);
+  curproc->nvcsw++;
+  chargeself(curproc, 0);
+  requeue(curproc);
   sched();
-  release(&ptable.lock);
+  release(curproc->lock);
+  return 0;
 }
 
 // A fork child's very first scheduling by scheduler()
@@ -583,8 +1275,11 @@ void yield(void)
 void forkret(void)
 {
   static int first = 1;
-  // Still holding ptable.lock from scheduler.
-  release(&ptable.lock);
+  // Still holding our lock from scheduler() or sched(), and,
+  // if sched() switched straight here, the lock of the process
+  // it switched from.
+  finishswitch();
+  release(myproc()->lock);
 
   if (first)
   {
@@ -604,6 +1299,7 @@ void forkret(void)
 void sleep(void *chan, struct spinlock *lk)
 {
   struct proc *p = myproc();
+  struct spinlock *qlk;
 
   if (p == 0)
     panic("sleep");
@@ -611,20 +1307,25 @@ void sleep(void *chan, struct spinlock *lk)
   if (lk == 0)
     panic("sleep without lk");
 
-  // Must acquire ptable.lock in order to
-  // change p->state and then call sched.
-  // Once we hold ptable.lock, we can be
+  // Must acquire p->lock in order to
+  // change p->state and then call sched,
+  // and chan's sleep queue lock to join it.
+  // Once we hold the queue lock, we can be
   // guaranteed that we won't miss any wakeup
-  // (wakeup runs with ptable.lock locked),
+  // (wakeup runs with it locked),
   // so it's okay to release lk.
-  if (lk != &ptable.lock)
-  {                        // DOC: sleeplock0
-    acquire(&ptable.lock); // DOC: sleeplock1
-    release(lk);
-  }
+  qlk = sleepqlock(chan); // DOC: sleeplock0
+  acquire(qlk);           // DOC: sleeplock1
+  acquire(p->lock);
+  release(lk);
+
   // Go to sleep.
+  p->nvcsw++;
+  chargeself(p, 1);
   p->chan = chan;
   p->state = SLEEPING;
+  sleepqinsert(p);
+  release(qlk);
 
   sched();
 
@@ -632,32 +1333,100 @@ void sleep(void *chan, struct spinlock *lk)
   p->chan = 0;
 
   // Reacquire original lock.
-  if (lk != &ptable.lock)
-  { // DOC: sleeplock2
-    release(&ptable.lock);
-    acquire(lk);
-  }
+  release(p->lock); // DOC: sleeplock2
+  acquire(lk);
+}
+
+// Sleeping processes are kept on a list per hash bucket of their
+// wait channel, so wakeup() looks only at processes that could be
+// sleeping on chan instead of at the whole process table.  Each
+// bucket has its own lock, which must be held, and is taken before
+// the locks of the processes on it.
+static struct proc **
+sleepqhead(void *chan)
+{
+  return &ptable.sleepq[(uint)chan % NSLEEPQ];
+}
+
+static struct spinlock *
+sleepqlock(void *chan)
+{
+  return &ptable.sleeplock[(uint)chan % NSLEEPQ];
 }
 
-// PAGEBREAK!
-//  Wake up all processes sleeping on chan.
-//  The ptable lock must be held.
 static void
-wakeup1(void *chan)
+sleepqinsert(struct proc *p)
 {
-  struct proc *p;
+  struct proc **head = sleepqhead(p->chan);
+
+  p->sleepprev = 0;
+  p->sleepnext = *head;
+  if (*head)
+    (*head)->sleepprev = p;
+  *head = p;
+}
 
-  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-    if (p->state == SLEEPING && p->chan == chan)
-      p->state = RUNNABLE;
+static void
+sleepqremove(struct proc *p)
+{
+  if (p->sleepprev)
+    p->sleepprev->sleepnext = p->sleepnext;
+  else
+    *sleepqhead(p->chan) = p->sleepnext;
+  if (p->sleepnext)
+    p->sleepnext->sleepprev = p->sleepprev;
+  p->sleepnext = p->sleepprev = 0;
+}
+
+// Take a SLEEPING process off its sleep queue and make it RUNNABLE.
+// Its sleep queue lock and p->lock must be held.
+static void
+wake(struct proc *p)
+{
+  sleepqremove(p);
+  p->woken = 1;
+  p->wakeTick = ticks;
+  makerunnable(p, 0);
 }
 
+// PAGEBREAK!
 // Wake up all processes sleeping on chan.
 void wakeup(void *chan)
 {
-  acquire(&ptable.lock);
-  wakeup1(chan);
-  release(&ptable.lock);
+  struct spinlock *qlk = sleepqlock(chan);
+  struct proc *p, *next;
+
+  acquire(qlk);
+  __sync_fetch_and_add(&schedstats.wakeups, 1);
+  for (p = *sleepqhead(chan); p; p = next)
+  {
+    next = p->sleepnext;
+    __sync_fetch_and_add(&schedstats.scanned, 1);
+    if (p->chan == chan)
+    {
+      __sync_fetch_and_add(&schedstats.woken, 1);
+      acquire(p->lock);
+      wake(p);
+      release(p->lock);
+    }
+  }
+  release(qlk);
+}
+
+// Wake p, which was process pid, if it is still asleep on chan.
+// For callers that looked at p under p->lock and let go of it,
+// since the sleep queue lock has to be taken first.
+static void
+wakeproc(struct proc *p, int pid, void *chan)
+{
+  struct spinlock *qlk = sleepqlock(chan);
+
+  acquire(qlk);
+  acquire(p->lock);
+  if (p->pid == pid && p->state == SLEEPING && p->chan == chan)
+    wake(p);
+  release(p->lock);
+  release(qlk);
 }
 
 // Kill the process with the given pid.
@@ -666,22 +1435,18 @@ void wakeup(void *chan)
 int kill(int pid)
 {
   struct proc *p;
+  void *chan = 0;
 
-  acquire(&ptable.lock);
-  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-  {
-    if (p->pid == pid)
-    {
-      p->killed = 1;
-      // Wake process from sleep if necessary.
-      if (p->state == SLEEPING)
-        p->state = RUNNABLE;
-      release(&ptable.lock);
-      return 0;
-    }
-  }
-  release(&ptable.lock);
-  return -1;
+  if ((p = lockproc(pid)) == 0)
+    return -1;
+  p->killed = 1;
+  // Wake process from sleep if necessary.
+  if (p->state == SLEEPING)
+    chan = p->chan;
+  release(p->lock);
+  if (chan)
+    wakeproc(p, pid, chan);
+  return 0;
 }
 
 // PAGEBREAK: 36
@@ -702,10 +1467,9 @@ void procdump(void)
   char *state;
   uint pc[10];
 
-  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+  cprintf("scheduler: %s\n", schedclasses[schedpolicy].name);
+  for (p = ptable.live; p; p = p->livenext)
   {
-    if (p->state == UNUSED)
-      continue;
     if (p->state >= 0 && p->state < NELEM(states) && states[p->state])
       state = states[p->state];
     else
@@ -746,9 +1510,14 @@ int thread_create(void (*fcn)(void *), void *arg, void *stack)
   // }
   np->sz = curproc->sz;
   np->parent = curproc;
+  np->predBurst = curproc->predBurst;
+  np->nice = curproc->nice;
+  np->vruntime = curproc->vruntime;
+  np->affinity = curproc->affinity;
   *np->tf = *curproc->tf;
   np->pgdir = curproc->pgdir;
   np->is_thread = 1;
+  np->ingang = curproc->ingang = 1;
   np->tf->eax = 0;
   np->tf->eip = (uint)fcn;
   np->tf->esp = (uint)stack;
@@ -767,11 +1536,13 @@ int thread_create(void (*fcn)(void *), void *arg, void *stack)
 
   pid = np->pid;
 
-  acquire(&ptable.lock);
-
-  np->state = RUNNABLE;
+  acquire(&ptable.waitlock);
+  childlink(&curproc->children, np);
+  release(&ptable.waitlock);
 
-  release(&ptable.lock);
+  acquire(np->lock);
+  makerunnable(np, 0);
+  release(np->lock);
 
   return pid;
 }
@@ -784,42 +1555,38 @@ int thread_join(void)
   int havekids, pid;
   struct proc *curproc = myproc();
 
-  acquire(&ptable.lock);
+  acquire(&ptable.waitlock);
   for (;;)
   {
-    // Scan through table looking for exited children.
-    havekids = 0;
-    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    // Reap the first exited child, if any.
+    havekids = curproc->children || curproc->zombies;
+    if ((p = curproc->zombies) != 0)
     {
-      if (p->parent != curproc)
-        continue;
-      havekids = 1;
-      if (p->state == ZOMBIE)
-      {
-        // Found one.
-        pid = p->pid;
-        kfree(p->kstack);
-        p->kstack = 0;
-        // freevm(p->pgdir);
-        p->pid = 0;
-        p->parent = 0;
-        p->name[0] = 0;
-        p->killed = 0;
-        p->state = UNUSED;
-        release(&ptable.lock);
-        return pid;
-      }
+      // Found one.  Its lock is held until it has switched off its
+      // stack for the last time.
+      pid = p->pid;
+      childunlink(p);
+      release(&ptable.waitlock);
+      acquire(p->lock);
+      kfree(p->kstack);
+      p->kstack = 0;
+      // freevm(p->pgdir);
+      acquire(&ptable.pidlock);
+      procfree(p);
+      release(&ptable.pidlock);
+      release(p->lock);
+      return pid;
     }
 
     // No point waiting if we don't have any children.
     if (!havekids || curproc->killed)
     {
-      release(&ptable.lock);
+      release(&ptable.waitlock);
       return -1;
     }
 
-    // Wait for children to exit.  (See wakeup1 call in proc_exit.)
-    sleep(curproc, &ptable.lock); // DOC: wait-sleep
+    // Wait for children to exit.  (See wakeup call in proc_exit.)
+    sleep(curproc, &ptable.waitlock); // DOC: wait-sleep
   }
 }
 
@@ -829,7 +1596,6 @@ int thread_join(void)
 void thread_exit(void)
 {
   struct proc *curproc = myproc();
-  struct proc *p;
   int fd;
 
   if (curproc == initproc)
@@ -850,118 +1616,257 @@ void thread_exit(void)
   end_op();
   curproc->cwd = 0;
 
-  acquire(&ptable.lock);
+  acquire(&ptable.waitlock);
 
   // Parent might be sleeping in wait().
-  wakeup1(curproc->parent);
+  wakeup(curproc->parent);
 
   // Pass abandoned children to init.
-  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-  {
-    if (p->parent == curproc)
-    {
-      p->parent = initproc;
-      if (p->state == ZOMBIE)
-        wakeup1(initproc);
-    }
-  }
+  reparent(curproc);
+  acquire(curproc->lock);
+  curproc->etime = ticks;
   curproc->state = ZOMBIE;
+  release(&ptable.waitlock);
   sched();
   panic("zombie exit");
 }
 
+// Lock-free: a single word read, current as of some moment
+// during the call.
 int getNumProc()
 {
-  acquire(&ptable.lock);
-  int cnt = 0;
-  for (struct proc *p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-  {
-    if (p->state != UNUSED)
-    {
-
-      cnt++;
-    }
-    // else
-    //   break;
-    // printf("%p",p);
-  }
-  // printf("%d",cnt);
-  release(&ptable.lock);
-  return cnt;
+  return ptable.nproc;
 }
 
+// Lock-free: pids only grow and the live list is newest first, so
+// the first live process has the largest pid.  procalloc() sets the
+// pid before it links a process in, and procs are never given back
+// to kalloc(), so a stale pointer still reads a pid that was live a
+// moment ago.
 int getMaxPid()
 {
-  acquire(&ptable.lock);
-  int mxpid = -1;
-  for (struct proc *p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-  {
-    if (p->state != UNUSED)
-    {
+  struct proc *p = ptable.live;
 
-      mxpid = (mxpid > p->pid ? mxpid : p->pid);
-    }
-    // printf(1,"%d",p->pid);
-    // printf("%p",p);
-  }
-  release(&ptable.lock);
-  return mxpid;
+  return p ? p->pid : -1;
 }
 
+// Needs only pidlock, which keeps the process from being freed
+// while its record is copied.
 int getProcInfoStruct(int pid, struct processInfo *processInfo)
 {
-  acquire(&ptable.lock);
-  int chala = 0;
-  for (struct proc *p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+  struct proc *p;
+
+  acquire(&ptable.pidlock);
+  if ((p = pidlookup(pid)) == 0)
   {
+    release(&ptable.pidlock);
+    return -1;
+  }
+  procinfo(p, processInfo);
+  release(&ptable.pidlock);
+  return 0;
+}
 
-    if (p->pid == pid)
-    {
+int set_burst_time(int n)
+{
+  struct proc *currp = myproc();
+
+  if (n < 1)
+    return -1;
+
+  acquire(currp->lock);
+  // currp is RUNNING, so it is not on the ready queue; the new
+  // key takes effect when yield() below queues it again.
+  currp->burstTime = n;
+  currp->quantum = burstquantum(n);
+
+  release(currp->lock);
+  yield();
+  return 0;
+}
+
+// Make the caller a real-time process that needs runtime ticks of
+// cpu every period ticks, each within deadline ticks of the start
+// of the period (deadline 0 means the whole period).  It is
+// admitted to the cpu with the most room left if its share,
+// runtime/deadline, still fits under RT_MAXUTIL there; that keeps
+// every deadline on that cpu under EDF.  runtime 0 makes it an
+// ordinary process again.  Returns -1 if the parameters are bad or
+// it cannot be admitted.
+int setrealtime(int period, int runtime, int deadline)
+{
+  struct proc *p = myproc();
+  struct cpu *c = 0;
+  int i, util = 0, used, least = 0;
 
-      processInfo->ppid = p->parent->pid;
-      processInfo->psize = p->sz;
-      processInfo->numberContextSwitches = p->numContextSwitches;
-      // processInfo->burstTime=0;
-      chala = 1;
+  if (deadline == 0)
+    deadline = period;
+  if (runtime < 0 ||
+      (runtime > 0 && (period <= 0 || deadline < runtime || deadline > period)))
+    return -1;
+  if (runtime > 0)
+    util = (runtime * 1000 + deadline - 1) / deadline;
 
-      break;
+  acquire(&ptable.rtlock);
+  if (runtime > 0)
+  {
+    for (i = 0; i < ncpu; i++)
+    {
+      // Our own current reservation does not count.
+      if (!(p->affinity & (1 << i)))
+        continue;
+      used = cpus[i].rtutil;
+      if (p->rtRuntime && p->cpu == i)
+        used -= p->rtUtil;
+      if (used + util <= RT_MAXUTIL && (c == 0 || used < least))
+      {
+        c = &cpus[i];
+        least = used;
+      }
+    }
+    if (c == 0)
+    {
+      release(&ptable.rtlock);
+      return -1;
     }
   }
+  rtleave(p);
+  if (runtime > 0)
+  {
+    p->rtRuntime = runtime;
+    p->rtPeriod = period;
+    p->rtDeadline = deadline;
+    p->rtUtil = util;
+    p->rtBudget = runtime;
+    p->rtStart = ticks;
+    p->rtDeadlineAt = ticks + deadline;
+    p->rtnext = ptable.rt;
+    ptable.rt = p;
+    p->cpu = c - cpus;
+    c->rtutil += util;
+  }
+  release(&ptable.rtlock);
 
-  if (!chala)
+  // Get back in line under the new class, on the new cpu.
+  yield();
+  return 0;
+}
+
+// Let process pid, or the caller if pid is 0, run only on the cpus
+// whose bits are set in mask.  A queued process moves to an allowed
+// cpu at once, a running one the next time it is queued.  Fails if
+// mask allows no cpu, or leaves out the cpu a real-time process
+// was admitted to.
+int setaffinity(int pid, uint mask)
+{
+  struct proc *p;
+  int move;
+
+  mask &= (1 << ncpu) - 1;
+  if (mask == 0)
+    return -1;
+  if (pid == 0)
+    pid = myproc()->pid;
+
+  if ((p = lockproc(pid)) == 0)
+    return -1;
+  if (p->rtRuntime && !(mask & (1 << p->cpu)))
   {
-    release(&ptable.lock);
+    release(p->lock);
     return -1;
   }
-  release(&ptable.lock);
+  p->affinity = mask;
+  if (p->state == RUNNABLE && !(mask & (1 << p->rqcpu)) && rqtake(p))
+    makerunnable(p, 0);
+  // Decide while interrupts are still off, as cpuid() requires.
+  move = p == myproc() && !(mask & (1 << cpuid()));
+  release(p->lock);
+
+  if (move)
+    yield();
   return 0;
 }
 
-int set_burst_time(int n)
+// Copy the idle accounting of cpu n to user space.
+int getcpuinfo(int n, struct cpuInfo *info)
 {
-  acquire(&ptable.lock);
+  struct cpu *c;
 
-  struct proc *currp = myproc();
+  if (n < 0 || n >= ncpu)
+    return -1;
+  c = &cpus[n];
+  info->apicid = c->apicid;
+  info->idleTicks = c->idleticks;
+  info->busyTicks = c->busyticks;
+  info->halts = c->halts;
+  info->runnable = c->rq.n;
+  return 0;
+}
 
-  if (n < 1)
+// Copy the sleep/wakeup counters to user space.  Lock-free: each
+// counter is read whole, but they may be a wakeup apart from each
+// other.
+int getschedstats(struct schedStats *st)
+{
+  *st = schedstats;
+  return 0;
+}
+
+// Copy a record of each of up to n processes to procs[] in a
+// single pass over the table.  Returns the number copied.  Needs
+// only pidlock, so a listing does not hold up scheduling.
+int getprocs(struct uproc *procs, int n)
+{
+  struct proc *p;
+  struct uproc *u = procs;
+
+  acquire(&ptable.pidlock);
+  for (p = ptable.live; p && u < procs + n; p = p->livenext)
   {
-    release(&ptable.lock);
-    return -1;
+    u->pid = p->pid;
+    u->ppid = p->parent ? p->parent->pid : 0;
+    u->state = p->state;
+    u->sz = p->sz;
+    u->burstTime = p->burstTime;
+    u->switches = p->numContextSwitches;
+    u->ticks = p->utime + p->stime;
+    safestrcpy(u->name, p->name, sizeof(u->name));
+    u++;
   }
-  currp->burstTime = n;
-  if (n < TimeQuanta)
-    TimeQuanta = n;
+  release(&ptable.pidlock);
+  return u - procs;
+}
 
-  release(&ptable.lock);
-  yield();
+// Set the nice value of process pid, or of the caller if pid is 0.
+// Lower values get a larger share of the CPU under SCHED_CFS.
+int setnice(int pid, int nice)
+{
+  struct proc *p;
+
+  if (nice < NICE_MIN || nice > NICE_MAX)
+    return -1;
+  if (pid == 0)
+    pid = myproc()->pid;
+
+  acquire(&ptable.pidlock);
+  if ((p = pidlookup(pid)) == 0)
+  {
+    release(&ptable.pidlock);
+    return -1;
+  }
+  p->nice = nice;
+  release(&ptable.pidlock);
   return 0;
 }
 
-int get_burst_time()
+// Burst time the scheduler currently predicts for this process,
+// used in place of a burst time it never set.
+int get_predicted_burst()
 {
-  acquire(&ptable.lock);
+  return myproc()->predBurst;
+}
 
-  struct proc *currp = myproc();
-  release(&ptable.lock);
-  return currp->burstTime;
+int get_burst_time()
+{
+  return myproc()->burstTime;
 }
\ No newline at end of file
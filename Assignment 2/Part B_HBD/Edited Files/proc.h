@@ -1,3 +1,17 @@
+// Ready queue of RUNNABLE processes, kept as a binary min-heap
+// so that picking the next process is O(log n) instead of a sort
+// of the whole table.  Ordered by (rqround, rqkey, rqseq);
+// see rqbefore() in schedcore.c.  Each CPU has its own, changed
+// with that cpu's run queue lock held.
+struct runq
+{
+  struct proc *heap[NPROC];
+  int n;      // number of queued processes
+  uint round; // hybrid round currently being served
+  uint seq;   // enqueue counter, FIFO among equal keys
+  uint minvruntime; // vruntime of the last process picked (CFS)
+};
+
 // Per-CPU state
 struct cpu
 {
@@ -9,6 +23,16 @@ struct cpu
   int ncli;                  // Depth of pushcli nesting.
   int intena;                // Were interrupts enabled before pushcli?
   struct proc *proc;         // The process running on this cpu or null
+  struct runq rq;            // Processes waiting to run on this cpu
+  volatile int idle;         // Halted for lack of work?
+  uint idleticks;            // Timer ticks with no process to run
+  uint busyticks;            // Timer ticks spent running a process
+  uint halts;                // Times halted for lack of work
+  int rtutil;                // Per-mille reserved by real-time processes
+  struct proc *handoff;      // Run this next, see yield_to()
+  int handoffslice;          // Time quanta it inherits
+  struct proc *prev;         // Switched out, see finishswitch()
+  int requeue;               // Queue prev once it is switched out
 };
 
 extern struct cpu cpus[NCPU];
@@ -50,6 +74,7 @@ struct proc
   uint sz;                    // Size of process memory (bytes)
   pde_t *pgdir;               // Page table
   char *kstack;               // Bottom of kernel stack for this process
+  struct spinlock *lock;      // Guards state, killed and chan, see proc.c
   enum procstate state;       // Process state
   int pid;                    // Process ID
   struct proc *parent;        // Parent process
@@ -63,9 +88,57 @@ struct proc
   int is_thread;
   int burstTime;
   int numContextSwitches;
-  int alreadyRun;
-  int time_slice; // for time quanta
+  int alreadyRun; // dispatched at least once
+  int time_slice; // ticks used of the current time quanta
+  int quantum;    // length of this process's time quanta, in ticks
   int first_proc; // to indicate shortest process
+  int rqidx;      // index in runq heap, -1 if not queued
+  int rqcpu;      // cpu whose runq it is on, when queued
+  uint rqkey;     // sort key it was queued with, see makerunnable()
+  uint rqround;   // hybrid round this process is queued for
+  uint rqseq;     // enqueue order, breaks ties between equal keys
+  int cpu;        // cpu last run on (whose runq we join), -1 if never
+  int oncpu;      // running, or still switching out, on some cpu
+  uint affinity;  // bit i set if it may run on cpu i
+  int migrations; // times dispatched on a different cpu than last time
+  int ingang;     // shares its address space with threads
+  int gangboost;  // queued ahead of others to run with its siblings
+  int predBurst;  // predicted CPU burst in ticks, exponential average
+  int burstTicks; // ticks run so far in the current CPU burst
+  uint burstStart; // ticks when last dispatched or charged
+  int mlfqLevel;  // MLFQ priority level, 0 is highest
+  int nice;       // NICE_MIN..NICE_MAX, sets the CFS weight
+  uint vruntime;  // weighted CPU time received (CFS)
+  int rtRuntime;  // real-time budget per period in ticks, 0 if not real-time
+  int rtPeriod;   // real-time period in ticks
+  int rtDeadline; // relative deadline in ticks, at most rtPeriod
+  int rtUtil;     // per-mille of its cpu reserved, see setrealtime()
+  int rtBudget;   // ticks of budget left in this period
+  uint rtStart;   // ticks at which the current period started
+  uint rtDeadlineAt; // absolute deadline of the current period
+  struct proc *rtnext; // next on the list of real-time processes
+  struct proc *livenext;  // next in ptable's live list, or free list
+  struct proc *liveprev;  // previous in the live list, 0 if first
+  struct proc *pidnext;   // next in its pid hash chain
+  struct proc *children;  // children that have not exited
+  struct proc *zombies;   // children that exited, waiting to be reaped
+  struct proc *sibling;   // next in the parent's children or zombies
+  struct proc **psibling; // link pointing at us, 0 if on neither
+  struct proc *sleepnext; // next in its wait channel's sleep queue
+  struct proc *sleepprev; // previous in that queue, 0 if first
+  int woken;      // made RUNNABLE by wakeup(), not yet dispatched
+  uint wakeTick;  // ticks at that wakeup
+  uint utime;     // timer ticks spent in user mode
+  uint stime;     // timer ticks spent in the kernel
+  uint waitTicks; // ticks spent RUNNABLE, waiting for a cpu
+  uint maxWait;   // longest single wait for a cpu, in ticks
+  uint readyTick; // ticks when last made RUNNABLE
+  uint ctime;     // ticks at creation
+  uint firstRun;  // ticks when first dispatched, once alreadyRun
+  uint etime;     // ticks at exit
+  int nvcsw;      // voluntary context switches (blocked)
+  int nivcsw;     // involuntary context switches (preempted)
+  int pageFaults; // page faults taken
 };
 
 // Process memory is laid out contiguously, low addresses first:
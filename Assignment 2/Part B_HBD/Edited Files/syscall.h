@@ -28,4 +28,16 @@
 #define SYS_getMaxPid 27
 #define SYS_getProcInfoStruct 28
 #define SYS_set_burst_time 29
-#define SYS_get_burst_time 30
\ No newline at end of file
+#define SYS_get_burst_time 30
+#define SYS_get_predicted_burst 31
+#define SYS_setnice 32
+#define SYS_setscheduler 33
+#define SYS_getcpuinfo 34
+#define SYS_getschedstats 35
+#define SYS_waitinfo 36
+#define SYS_getprocs 37
+#define SYS_setaging 38
+#define SYS_setrealtime 39
+#define SYS_setaffinity 40
+#define SYS_setgang 41
+#define SYS_yield_to 42
\ No newline at end of file
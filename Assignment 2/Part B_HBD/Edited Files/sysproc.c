@@ -6,6 +6,11 @@
 #include "memlayout.h"
 #include "mmu.h"
 #include "proc.h"
+#include "processInfo.h"
+#include "cpuInfo.h"
+#include "schedStats.h"
+#include "timer.h"
+#include "uproc.h"
 
 int sys_fork(void)
 {
@@ -54,19 +59,26 @@ int sys_sleep(void)
 {
   int n;
   uint ticks0;
+  struct timer t;
 
   if (argint(0, &n) < 0)
     return -1;
+  if (n <= 0)
+    return 0;
   acquire(&tickslock);
   ticks0 = ticks;
+  // Only the timer wakes us, not every tick.
+  t.pprev = 0;
+  settimer(&t, ticks0 + n, wakeup, &t);
   while (ticks - ticks0 < n)
   {
     if (myproc()->killed)
     {
+      deltimer(&t);
       release(&tickslock);
       return -1;
     }
-    sleep(&ticks, &tickslock);
+    sleep(&t, &tickslock);
   }
   release(&tickslock);
   return 0;
@@ -179,7 +191,8 @@ int sys_getProcInfoStruct()
   int pid;
   struct processInfo *p;
   argptr(0, (void *)&pid, sizeof(pid));
-  argptr(1, (void *)&p, sizeof(p));
+  if (argptr(1, (void *)&p, sizeof(*p)) < 0)
+    return -1;
   return getProcInfoStruct(pid, p);
 }
 
@@ -192,4 +205,114 @@ int sys_set_burst_time()
 
 int sys_get_burst_time(){
   return get_burst_time();
+}
+
+int sys_get_predicted_burst(void)
+{
+  return get_predicted_burst();
+}
+
+int sys_setnice(void)
+{
+  int pid, nice;
+
+  if (argint(0, &pid) < 0 || argint(1, &nice) < 0)
+    return -1;
+  return setnice(pid, nice);
+}
+
+int sys_setscheduler(void)
+{
+  int n;
+
+  if (argint(0, &n) < 0)
+    return -1;
+  return setscheduler(n);
+}
+
+int sys_getcpuinfo(void)
+{
+  int n;
+  struct cpuInfo *info;
+
+  if (argint(0, &n) < 0 || argptr(1, (void *)&info, sizeof(*info)) < 0)
+    return -1;
+  return getcpuinfo(n, info);
+}
+
+int sys_getschedstats(void)
+{
+  struct schedStats *st;
+
+  if (argptr(0, (void *)&st, sizeof(*st)) < 0)
+    return -1;
+  return getschedstats(st);
+}
+
+int sys_waitinfo(void)
+{
+  struct processInfo *info;
+
+  if (argptr(0, (void *)&info, sizeof(*info)) < 0)
+    return -1;
+  return waitinfo(info);
+}
+
+int sys_getprocs(void)
+{
+  struct uproc *procs;
+  int n;
+
+  if (argint(1, &n) < 0 || n < 0)
+    return -1;
+  if (n > NPROC)
+    n = NPROC;
+  if (argptr(0, (void *)&procs, n * sizeof(*procs)) < 0)
+    return -1;
+  return getprocs(procs, n);
+}
+
+int sys_setaging(void)
+{
+  int n;
+
+  if (argint(0, &n) < 0)
+    return -1;
+  return setaging(n);
+}
+
+int sys_setrealtime(void)
+{
+  int period, runtime, deadline;
+
+  if (argint(0, &period) < 0 || argint(1, &runtime) < 0 || argint(2, &deadline) < 0)
+    return -1;
+  return setrealtime(period, runtime, deadline);
+}
+
+int sys_setaffinity(void)
+{
+  int pid, mask;
+
+  if (argint(0, &pid) < 0 || argint(1, &mask) < 0)
+    return -1;
+  return setaffinity(pid, mask);
+}
+
+int sys_setgang(void)
+{
+  int on;
+
+  if (argint(0, &on) < 0)
+    return -1;
+  return setgang(on);
+}
+
+int sys_yield_to(void)
+{
+  int pid;
+
+  if (argint(0, &pid) < 0)
+    return -1;
+  return yield_to(pid);
 }
\ No newline at end of file
@@ -48,15 +48,32 @@ void trap(struct trapframe *tf)
   switch (tf->trapno)
   {
   case T_IRQ0 + IRQ_TIMER:
+    if (mycpu()->proc)
+    {
+      mycpu()->busyticks++;
+      if ((tf->cs & 3) == DPL_USER)
+        myproc()->utime++;
+      else
+        myproc()->stime++;
+    }
+    else
+      mycpu()->idleticks++;
     if (cpuid() == 0)
     {
       acquire(&tickslock);
       ticks++;
-      wakeup(&ticks);
+      runtimers();
       release(&tickslock);
+      if (ticks % MLFQ_BOOST == 0)
+        mlfqboost();
+      rttick();
     }
     lapiceoi();
     break;
+  case T_IRQ0 + IRQ_WAKEUP:
+    // Another cpu queued work for us; scheduler() picks it up.
+    lapiceoi();
+    break;
   case T_IRQ0 + IRQ_IDE:
     ideintr();
     lapiceoi();
@@ -81,6 +98,8 @@ void trap(struct trapframe *tf)
 
   // PAGEBREAK: 13
   default:
+    if (tf->trapno == T_PGFLT && myproc())
+      myproc()->pageFaults++;
     if (myproc() == 0 || (tf->cs & 3) == 0)
     {
       // In kernel, it must be our mistake.
@@ -102,36 +121,13 @@ void trap(struct trapframe *tf)
   if (myproc() && myproc()->killed && (tf->cs & 3) == DPL_USER)
     exit();
 
-  // Force process to give up CPU on clock tick.
+  // Force process to give up CPU on clock tick once the scheduling
+  // policy says its time quanta is complete (see schedtick()).
   // If interrupts were on while locks held, would need to check nlock.
-
-  // As there will be no context switches in case of sjf scheduling.
-  // for Default
-  // if(myproc() && myproc()->state == RUNNING &&
-  //    tf->trapno == T_IRQ0+IRQ_TIMER)
-  //   yield();
-
-  // for SJF
-  // no context switching
-  
-  // for hybrid scheduling
   if (myproc() && myproc()->state == RUNNING &&
-      tf->trapno == T_IRQ0 + IRQ_TIMER)
-  {
-    struct proc *p = myproc();
-
-    // acquire(&ptable.lock);
-    p->time_slice += 1;
-
-    int n = p->time_slice;
-    // release(&ptable.lock);
+      tf->trapno == T_IRQ0 + IRQ_TIMER && schedtick(myproc()))
+    yield();
 
-    if (n % TimeQuanta == 0)
-    {
-      yield(); // one more Time Quanta is complete
-    }
-    // return 0;
-  }
   // Check if the process has been killed since we yielded
   if (myproc() && myproc()->killed && (tf->cs & 3) == DPL_USER)
     exit();
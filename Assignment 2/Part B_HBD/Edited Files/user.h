@@ -3,6 +3,9 @@
 struct stat;
 struct rtcdate;
 struct processInfo;
+struct cpuInfo;
+struct schedStats;
+struct uproc;
 // system calls
 int fork(void);
 int exit(void) __attribute__((noreturn));
@@ -34,6 +37,18 @@ int getMaxPid(void);
 int getProcInfoStruct(int , struct processInfo*);
 int set_burst_time(int);
 int get_burst_time(void);
+int get_predicted_burst(void);
+int setnice(int, int);
+int setscheduler(int);
+int getcpuinfo(int, struct cpuInfo*);
+int getschedstats(struct schedStats*);
+int waitinfo(struct processInfo*);
+int getprocs(struct uproc*, int);
+int setaging(int);
+int setrealtime(int, int, int);
+int setaffinity(int, uint);
+int setgang(int);
+int yield_to(int);
 // ulib.c
 int stat(const char*, struct stat*);
 char* strcpy(char*, const char*);
@@ -47,3 +62,6 @@ void* memset(void*, int, uint);
 void* malloc(uint);
 void free(void*);
 int atoi(const char*);
+
+// spin.c
+void spin(int);
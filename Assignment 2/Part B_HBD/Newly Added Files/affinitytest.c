@@ -0,0 +1,48 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "processInfo.h"
+#include "cpuInfo.h"
+
+// CPU affinity (boot with CPUS=2 or more).  Runs twice as many CPU
+// bound children as there are cpus, first unpinned and then each
+// pinned to one cpu, and reports how often they migrated.  Pinned
+// children should migrate at most once, when they are pinned.
+
+void run(int pin, int ncpu)
+{
+    struct processInfo r;
+    int n = 0, migrations = 0;
+
+    for (int i = 0; i < 2 * ncpu; i++)
+    {
+        if (fork() == 0)
+        {
+            if (pin && setaffinity(0, 1 << (i % ncpu)) < 0)
+                printf(1, "setaffinity failed\n");
+            spin(300);
+            exit();
+        }
+    }
+    while (waitinfo(&r) != -1)
+    {
+        migrations += r.migrations;
+        n++;
+    }
+    printf(1, "%s: %d children, %d migrations\n", pin ? "pinned  " : "unpinned", n, migrations);
+}
+
+int main(int argc, char *argv[])
+{
+    struct cpuInfo info;
+    int ncpu = 0;
+
+    while (getcpuinfo(ncpu, &info) == 0)
+        ncpu++;
+    if (setaffinity(0, 0) == 0)
+        printf(1, "empty mask accepted, should not be\n");
+
+    run(0, ncpu);
+    run(1, ncpu);
+    exit();
+}
@@ -0,0 +1,87 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "processInfo.h"
+#include "schedPolicy.h"
+
+// Starvation under SJF (boot with CPUS=1).  One long job competes
+// with a steady stream of short ones for RUNTICKS ticks, first with
+// aging off and then with the default rate.  Without aging the long
+// job only gets to run once the stream dries up; with it, its
+// longest wait is bounded while the short jobs still finish first.
+//     agingtest [aging]
+
+#define RUNTICKS 200
+#define SHORTJOBS 4
+
+void run(int rate)
+{
+    struct processInfo r;
+    int n = 0, turnaround = 0;
+    int start = uptime();
+
+    setaging(rate);
+
+    if (fork() == 0)
+    {
+        set_burst_time(100);
+        spin(200);
+        exit();
+    }
+
+    // Keep a few short jobs runnable until RUNTICKS is up, then
+    // reap everything.
+    for (int live = 0;;)
+    {
+        while (uptime() - start < RUNTICKS && live < SHORTJOBS)
+        {
+            if (fork() == 0)
+            {
+                set_burst_time(1);
+                spin(2);
+                exit();
+            }
+            live++;
+        }
+        if (waitinfo(&r) < 0)
+            break;
+        if (r.burstTime == 100)
+        {
+            printf(1, "aging %d: long job waited %d ticks, longest wait %d, turnaround %d\n",
+                   rate, r.waitTicks, r.maxWaitTicks, r.exitTime - r.creationTime);
+            continue;
+        }
+        turnaround += r.exitTime - r.creationTime;
+        n++;
+        live--;
+    }
+    printf(1, "aging %d: %d short jobs, mean turnaround %d ticks\n",
+           rate, n, n ? turnaround / n : 0);
+}
+
+int main(int argc, char *argv[])
+{
+    int rate = -1;
+    int old = setscheduler(SCHED_SJF);
+    int oldaging;
+
+    if (old < 0)
+    {
+        // Not built in, see make SCHED=.
+        printf(1, "agingtest: no policy sjf in this kernel, skipped\n");
+        exit();
+    }
+    oldaging = setaging(0);
+
+    if (argc > 1)
+        rate = atoi(argv[1]);
+    if (rate <= 0)
+        rate = oldaging > 0 ? oldaging : 10;
+
+    run(0);
+    run(rate);
+
+    setaging(oldaging);
+    setscheduler(old);
+    exit();
+}
@@ -0,0 +1,8 @@
+struct cpuInfo
+{
+    int apicid;
+    int idleTicks; // timer ticks with nothing to run
+    int busyTicks; // timer ticks spent running a process
+    int halts;     // times the cpu halted waiting for work
+    int runnable;  // processes waiting in its run queue
+};
@@ -0,0 +1,21 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "cpuInfo.h"
+
+// Print how much time each cpu has spent idle since boot.
+int main(int argc, char *argv[])
+{
+    struct cpuInfo info;
+
+    printf(1, "CPU  Idle ticks  Busy ticks  Idle %%  Halts  Runnable\n");
+    for (int i = 0; getcpuinfo(i, &info) == 0; i++)
+    {
+        int total = info.idleTicks + info.busyTicks;
+        printf(1, "%d    %d          %d          %d      %d      %d\n",
+               i, info.idleTicks, info.busyTicks,
+               total ? info.idleTicks * 100 / total : 0,
+               info.halts, info.runnable);
+    }
+    exit();
+}
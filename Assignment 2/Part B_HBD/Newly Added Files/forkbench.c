@@ -0,0 +1,65 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// Process table scaling benchmark.  Boot with "make qemu CPUS=N"
+// and run
+//     forkbench [workers [forks]]
+// Each worker forks a child that exits at once and waits for it,
+// forks times over, so nearly all of the time goes to fork(),
+// exit() and wait() and the locks they take.  Prints
+//     workers=W forks=F ticks=T throughput=R
+// with R the forks done per 1000 ticks.  With one worker per cpu,
+// throughput should grow with the number of cpus as long as the
+// workers are not waiting on one another's locks.
+
+int main(int argc, char *argv[])
+{
+    int workers = 4, forks = 1000;
+    int start, elapsed, pid;
+
+    if (argc > 1)
+        workers = atoi(argv[1]);
+    if (argc > 2)
+        forks = atoi(argv[2]);
+    if (workers < 1 || forks < 1)
+    {
+        printf(2, "usage: forkbench [workers [forks]]\n");
+        exit();
+    }
+
+    start = uptime();
+    for (int i = 0; i < workers; i++)
+    {
+        if ((pid = fork()) < 0)
+        {
+            printf(2, "forkbench: fork failed after %d workers\n", i);
+            workers = i;
+            break;
+        }
+        if (pid == 0)
+        {
+            for (int j = 0; j < forks; j++)
+            {
+                if ((pid = fork()) < 0)
+                {
+                    printf(2, "forkbench: fork failed\n");
+                    break;
+                }
+                if (pid == 0)
+                    exit();
+                wait();
+            }
+            exit();
+        }
+    }
+    while (wait() != -1)
+        ;
+    elapsed = uptime() - start;
+    if (elapsed == 0)
+        elapsed = 1;
+
+    printf(1, "workers=%d forks=%d ticks=%d throughput=%d\n", workers,
+           workers * forks, elapsed, workers * forks * 1000 / elapsed);
+    exit();
+}
@@ -0,0 +1,44 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// Fork children that block on a pipe until fork() fails, then let
+// them all go.  With procs allocated on demand the count should be
+// limited by NPROC or by memory, not by a fixed table of 64.
+//     forklimit [max]
+
+int main(int argc, char *argv[])
+{
+    int max = 100000, n = 0, pid;
+    int fd[2];
+    char c;
+
+    if (argc > 1)
+        max = atoi(argv[1]);
+    if (pipe(fd) < 0)
+    {
+        printf(1, "pipe failed\n");
+        exit();
+    }
+
+    for (; n < max; n++)
+    {
+        if ((pid = fork()) < 0)
+            break;
+        if (pid == 0)
+        {
+            close(fd[1]);
+            read(fd[0], &c, 1);
+            exit();
+        }
+        if (n % 100 == 0)
+            printf(1, "%d processes, %d live\n", n, getNumProc());
+    }
+    printf(1, "forked %d children, %d processes live\n", n, getNumProc());
+
+    close(fd[1]);
+    while (wait() != -1)
+        ;
+    printf(1, "all reaped, %d processes live\n", getNumProc());
+    exit();
+}
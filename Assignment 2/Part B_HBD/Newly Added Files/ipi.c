@@ -0,0 +1,27 @@
+// Inter-processor interrupts, used to wake up halted cpus.
+
+#include "types.h"
+#include "defs.h"
+
+// Local APIC registers, divided by 4 for use as uint[] indices.
+// See lapic.c.
+#define ID      (0x0020/4)   // ID
+#define ICRLO   (0x0300/4)   // Interrupt Command
+  #define FIXED      0x00000000
+  #define DELIVS     0x00001000   // Delivery status
+#define ICRHI   (0x0310/4)   // Interrupt Command [63:32]
+
+// Send interrupt vector to the cpu with local APIC id apicid.
+void
+lapicipi(int apicid, int vector)
+{
+  if(!lapic)
+    return;
+
+  lapic[ICRHI] = apicid<<24;
+  lapic[ID];  // wait for write to finish, by reading
+  lapic[ICRLO] = FIXED | vector;
+  lapic[ID];
+  while(lapic[ICRLO] & DELIVS)
+    ;
+}
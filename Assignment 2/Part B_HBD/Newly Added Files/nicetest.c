@@ -0,0 +1,49 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "schedPolicy.h"
+
+// Fair-share check for SCHED_CFS (boot with CPUS=1): three CPU
+// bound children with different nice values spin for the same
+// wall-clock time.  The work each one gets
+// done should follow its weight, roughly 1 : 0.33 : 0.11 for nice
+// 0, 5 and 10, and nobody should starve.
+
+#define RUNTICKS 300
+
+int main(int argc, char *argv[])
+{
+    int nices[3] = {0, 5, 10};
+    int old = setscheduler(SCHED_CFS);
+
+    if (old < 0)
+    {
+        // Not built in, see make SCHED=.
+        printf(1, "nicetest: no policy cfs in this kernel, skipped\n");
+        exit();
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        if (fork() == 0)
+        {
+            int start, loops = 0;
+
+            if (setnice(0, nices[i]) < 0)
+                printf(1, "Couldn't set nice value for process %d\n", getpid());
+
+            start = uptime();
+            while (uptime() - start < RUNTICKS)
+            {
+                for (volatile int j = 0; j < 10000; j++)
+                    ;
+                loops++;
+            }
+            printf(1, "nice %d  pid %d  loops %d\n", nices[i], getpid(), loops);
+            exit();
+        }
+    }
+    while (wait() != -1)
+        ;
+    setscheduler(old);
+    exit();
+}
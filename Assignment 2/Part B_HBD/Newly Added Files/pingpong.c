@@ -0,0 +1,67 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// Switch latency benchmark: a parent and a child bounce one byte
+// back and forth over two pipes.  Every round is two sleep/wakeup
+// hand-offs, so with "make qemu CPUS=1" the rounds per 1000 ticks
+// mostly measure how fast the kernel gets from one process to the
+// next.  Usage: pingpong [rounds]
+
+int main(int argc, char *argv[])
+{
+    int rounds = 10000;
+    int ping[2], pong[2];
+    int start, elapsed, pid;
+    char c = 0;
+
+    if (argc > 1)
+        rounds = atoi(argv[1]);
+    if (rounds < 1)
+    {
+        printf(1, "usage: pingpong [rounds]\n");
+        exit();
+    }
+    if (pipe(ping) < 0 || pipe(pong) < 0)
+    {
+        printf(1, "pingpong: pipe failed\n");
+        exit();
+    }
+
+    pid = fork();
+    if (pid < 0)
+    {
+        printf(1, "pingpong: fork failed\n");
+        exit();
+    }
+    if (pid == 0)
+    {
+        close(ping[1]);
+        close(pong[0]);
+        while (read(ping[0], &c, 1) == 1)
+            write(pong[1], &c, 1);
+        exit();
+    }
+    close(ping[0]);
+    close(pong[1]);
+
+    start = uptime();
+    for (int i = 0; i < rounds; i++)
+    {
+        if (write(ping[1], &c, 1) != 1 || read(pong[0], &c, 1) != 1)
+        {
+            printf(1, "pingpong: lost the child after %d rounds\n", i);
+            rounds = i;
+            break;
+        }
+    }
+    elapsed = uptime() - start;
+    close(ping[1]);
+    wait();
+    if (elapsed == 0)
+        elapsed = 1;
+
+    printf(1, "rounds=%d ticks=%d throughput=%d\n",
+           rounds, elapsed, rounds * 1000 / elapsed);
+    exit();
+}
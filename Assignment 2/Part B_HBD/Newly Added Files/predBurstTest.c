@@ -0,0 +1,44 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// Neither child calls set_burst_time(); the kernel has to work out
+// their burst times on its own.  The CPU bound child's prediction
+// should climb towards the length of its bursts while the IO bound
+// child's stays near zero.
+
+volatile int sink;
+
+void cpuburst(int ticks)
+{
+    int start = uptime();
+
+    while (uptime() - start < ticks)
+        sink++;
+}
+
+int main(int argc, char *argv[])
+{
+    if (fork() == 0)
+    {
+        for (int i = 0; i < 5; i++)
+        {
+            cpuburst(10);
+            sleep(1); // end of this CPU burst
+            printf(1, "CPU Bound  pid %d  burst %d  predicted %d\n", getpid(), i, get_predicted_burst());
+        }
+        exit();
+    }
+    if (fork() == 0)
+    {
+        for (int i = 0; i < 5; i++)
+        {
+            sleep(5);
+            printf(1, "IO Bound   pid %d  burst %d  predicted %d\n", getpid(), i, get_predicted_burst());
+        }
+        exit();
+    }
+    while (wait() != -1)
+        ;
+    exit();
+}
@@ -3,5 +3,16 @@ struct processInfo
     int ppid;
     int psize;
     int numberContextSwitches;
-    // int burstTime;
+    int burstTime;
+    int userTicks;           // timer ticks spent in user mode
+    int sysTicks;            // timer ticks spent in the kernel
+    int waitTicks;           // ticks spent runnable but not running
+    int maxWaitTicks;        // longest of those waits
+    int creationTime;        // uptime() at creation
+    int exitTime;            // uptime() at exit, 0 while running
+    int firstRunTime;        // uptime() when first run
+    int voluntarySwitches;   // gave up the cpu to block
+    int involuntarySwitches; // preempted
+    int pageFaults;
+    int migrations;          // times moved to another cpu
 };
@@ -0,0 +1,84 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "param.h"
+#include "uproc.h"
+
+// List processes from one getprocs() snapshot.
+//     ps              print the table once
+//     ps delay [n]    top-like: reprint every delay ticks, n times
+//                     (forever if n is not given)
+
+char *states[] = {"unused", "embryo", "sleep ", "runble", "run   ", "zombie"};
+
+// Room for every process there can be.
+struct uproc procs[NPROC];
+
+void pad(int width, int n)
+{
+    int digits = 1;
+
+    for (int v = n < 0 ? -n : n; v >= 10; v /= 10)
+        digits++;
+    if (n < 0)
+        digits++;
+    for (; digits < width; digits++)
+        printf(1, " ");
+}
+
+void col(int width, int n)
+{
+    pad(width, n);
+    printf(1, "%d ", n);
+}
+
+void show(void)
+{
+    int n = getprocs(procs, NPROC);
+
+    if (n < 0)
+    {
+        printf(2, "ps: getprocs failed\n");
+        exit();
+    }
+    printf(1, "  PID  PPID STATE       SZ BURST   CSW  TICKS NAME\n");
+    for (int i = 0; i < n; i++)
+    {
+        struct uproc *u = &procs[i];
+
+        col(5, u->pid);
+        col(5, u->ppid);
+        printf(1, "%s ", u->state >= 0 && u->state < 6 ? states[u->state] : "???   ");
+        col(8, u->sz);
+        col(5, u->burstTime);
+        col(5, u->switches);
+        col(6, u->ticks);
+        printf(1, "%s\n", u->name);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int delay, count = -1;
+
+    if (argc < 2)
+    {
+        show();
+        exit();
+    }
+    delay = atoi(argv[1]);
+    if (argc > 2)
+        count = atoi(argv[2]);
+    if (delay <= 0)
+    {
+        printf(2, "usage: ps [delay [count]]\n");
+        exit();
+    }
+    for (; count != 0; count--)
+    {
+        printf(1, "\n--- uptime %d ---\n", uptime());
+        show();
+        sleep(delay);
+    }
+    exit();
+}
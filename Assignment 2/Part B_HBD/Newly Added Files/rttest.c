@@ -0,0 +1,95 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// A periodic control loop next to CPU-bound batch jobs.  Every
+// PERIOD ticks the loop does about WORK ticks of computing and
+// must be done within DEADLINE ticks.  It runs once as an ordinary
+// process and once admitted with setrealtime(); only the real-time
+// run should keep its response time under the deadline.
+//     rttest [batchjobs]
+
+#define PERIOD 10
+#define DEADLINE 8
+#define RUNTIME 4
+#define WORK 2
+#define PERIODS 30
+
+// Loops of spin(1) that take one tick, roughly.
+int calibrate(void)
+{
+    int n = 0, start = uptime();
+
+    while (uptime() == start)
+        ;
+    start = uptime();
+    while (uptime() - start < 10)
+    {
+        spin(1);
+        n++;
+    }
+    return n / 10 > 0 ? n / 10 : 1;
+}
+
+void controlloop(int rt, int pertick)
+{
+    int worst = 0, misses = 0;
+
+    if (rt && setrealtime(PERIOD, RUNTIME, DEADLINE) < 0)
+    {
+        printf(1, "setrealtime refused\n");
+        exit();
+    }
+    for (int i = 0; i < PERIODS; i++)
+    {
+        int start = uptime(), response;
+
+        spin(WORK * pertick);
+        response = uptime() - start;
+        if (response > worst)
+            worst = response;
+        if (response > DEADLINE)
+            misses++;
+        if (uptime() - start < PERIOD)
+            sleep(PERIOD - (uptime() - start));
+    }
+    printf(1, "%s: worst response %d ticks, %d of %d deadlines missed\n",
+           rt ? "real-time" : "ordinary ", worst, misses, PERIODS);
+    exit();
+}
+
+void run(int rt, int batch, int pertick)
+{
+    int pids[16];
+
+    for (int i = 0; i < batch; i++)
+        if ((pids[i] = fork()) == 0)
+            for (;;)
+                spin(1);
+    if (fork() == 0)
+        controlloop(rt, pertick);
+    wait();
+    for (int i = 0; i < batch; i++)
+        kill(pids[i]);
+    while (wait() != -1)
+        ;
+}
+
+int main(int argc, char *argv[])
+{
+    int batch = 4, pertick;
+
+    if (argc > 1)
+        batch = atoi(argv[1]);
+    if (batch > 16)
+        batch = 16;
+
+    // Admission control: a full cpu per period can never fit.
+    if (setrealtime(PERIOD, PERIOD, PERIOD) == 0)
+        printf(1, "admitted a 100%% reservation, should not have\n");
+
+    pertick = calibrate();
+    run(0, batch, pertick);
+    run(1, batch, pertick);
+    exit();
+}
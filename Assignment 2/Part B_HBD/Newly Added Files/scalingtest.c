@@ -0,0 +1,52 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// Multi-core throughput benchmark for the per-CPU run queues.
+// Boot with "make qemu CPUS=N" for N = 1..8 and run
+//     scalingtest [jobs] [work]
+// The same batch of CPU-bound jobs is pushed through the scheduler
+// each time; jobs per 100 ticks should grow with the number of CPUs.
+
+int main(int argc, char *argv[])
+{
+    int jobs = 16;
+    int work = 200;
+    int start, elapsed;
+
+    if (argc > 1)
+        jobs = atoi(argv[1]);
+    if (argc > 2)
+        work = atoi(argv[2]);
+    if (jobs < 1 || work < 1)
+    {
+        printf(1, "usage: scalingtest [jobs] [work]\n");
+        exit();
+    }
+
+    start = uptime();
+    for (int i = 0; i < jobs; i++)
+    {
+        int pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork failed after %d jobs\n", i);
+            jobs = i;
+            break;
+        }
+        if (pid == 0)
+        {
+            spin(work);
+            exit();
+        }
+    }
+    while (wait() != -1)
+        ;
+    elapsed = uptime() - start;
+    if (elapsed == 0)
+        elapsed = 1;
+
+    printf(1, "jobs %d  work %d  ticks %d  jobs/100 ticks %d\n",
+           jobs, work, elapsed, jobs * 100 / elapsed);
+    exit();
+}
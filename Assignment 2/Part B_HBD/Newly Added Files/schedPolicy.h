@@ -0,0 +1,7 @@
+// Scheduling policies, see setscheduler().
+#define SCHED_DEFAULT 0 // round robin, one tick each
+#define SCHED_SJF     1 // shortest burst first, no preemption
+#define SCHED_HBD     2 // hybrid: SJF order, one quanta each per round
+#define SCHED_MLFQ    3 // multi-level feedback queue
+#define SCHED_CFS     4 // fair share, least weighted virtual runtime first
+#define NSCHED        5 // number of policies
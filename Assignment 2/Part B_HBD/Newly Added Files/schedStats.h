@@ -0,0 +1,8 @@
+struct schedStats
+{
+    int wakeups;     // calls to wakeup()
+    int scanned;     // sleeping processes wakeup() looked at
+    int woken;       // processes wakeup() made runnable
+    int wokenRun;    // of those, how many have been dispatched since
+    int wakeLatency; // total ticks from wakeup to dispatch
+};
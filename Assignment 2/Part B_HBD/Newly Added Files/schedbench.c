@@ -0,0 +1,179 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "processInfo.h"
+#include "schedPolicy.h"
+
+// Scheduler benchmark.
+//     schedbench [jobs [seed [policy]]]
+// Starts the same seeded mix of CPU bound, I/O bound and mixed jobs
+// under each policy (or only the given SCHED_ number) and prints one
+// line of key=value pairs per policy:
+//     policy       scheduling policy
+//     jobs, ticks  jobs run and ticks from first fork to last exit
+//     throughput   jobs finished per 1000 ticks
+//     turnaround_* creation to exit
+//     wait_*       time spent runnable but not running
+//     response_*   creation to first run
+//     switches     context switches, all jobs together
+// with _mean, _p50 and _p99 for each of the times, all in ticks.
+
+#define MAXJOBS 64
+#define MAXWORK 40 // largest job, in units of about a tick of cpu
+
+char *policies[NSCHED] = {"default", "sjf", "hybrid", "mlfq", "cfs"};
+
+enum
+{
+    CPUBOUND,
+    IOBOUND,
+    MIXED
+};
+
+struct job
+{
+    int kind;
+    int work;    // units of cpu, or of sleeping for IOBOUND
+    int arrival; // ticks to wait after the previous job starts
+};
+
+struct job jobs[MAXJOBS];
+int turnaround[MAXJOBS], waiting[MAXJOBS], response[MAXJOBS];
+
+uint seed;
+
+uint rand(void)
+{
+    // xorshift32
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+void runjob(struct job *j)
+{
+    switch (j->kind)
+    {
+    case CPUBOUND:
+        spin(j->work);
+        break;
+    case IOBOUND:
+        for (int i = 0; i < j->work; i++)
+            sleep(1);
+        break;
+    case MIXED:
+        for (int i = 0; i < j->work; i += 2)
+        {
+            spin(2);
+            sleep(1);
+        }
+        break;
+    }
+    exit();
+}
+
+void sort(int *a, int n)
+{
+    for (int i = 1; i < n; i++)
+    {
+        int v = a[i], j;
+
+        for (j = i; j > 0 && a[j - 1] > v; j--)
+            a[j] = a[j - 1];
+        a[j] = v;
+    }
+}
+
+// Print key_mean, key_p50 and key_p99 of a[0..n-1], sorting it.
+void stats(char *key, int *a, int n)
+{
+    int sum = 0;
+
+    sort(a, n);
+    for (int i = 0; i < n; i++)
+        sum += a[i];
+    printf(1, " %s_mean=%d %s_p50=%d %s_p99=%d", key, sum / n,
+           key, a[(n - 1) / 2], key, a[(99 * n + 99) / 100 - 1]);
+}
+
+void bench(int pol, int n)
+{
+    struct processInfo r;
+    int start, elapsed, done = 0, switches = 0;
+
+    if (setscheduler(pol) < 0)
+    {
+        printf(2, "schedbench: no policy %d\n", pol);
+        return;
+    }
+
+    start = uptime();
+    for (int i = 0; i < n; i++)
+    {
+        if (jobs[i].arrival > 0)
+            sleep(jobs[i].arrival);
+        int pid = fork();
+        if (pid < 0)
+        {
+            printf(2, "schedbench: fork failed after %d jobs\n", i);
+            break;
+        }
+        if (pid == 0)
+            runjob(&jobs[i]);
+    }
+    while (waitinfo(&r) != -1)
+    {
+        turnaround[done] = r.exitTime - r.creationTime;
+        waiting[done] = r.waitTicks;
+        response[done] = r.firstRunTime - r.creationTime;
+        switches += r.numberContextSwitches;
+        done++;
+    }
+    elapsed = uptime() - start;
+    if (done == 0)
+        return;
+    if (elapsed == 0)
+        elapsed = 1;
+
+    printf(1, "policy=%s jobs=%d ticks=%d throughput=%d", policies[pol], done,
+           elapsed, done * 1000 / elapsed);
+    stats("turnaround", turnaround, done);
+    stats("wait", waiting, done);
+    stats("response", response, done);
+    printf(1, " switches=%d\n", switches);
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 20, first = 0, last = NSCHED - 1, old;
+
+    seed = 1;
+    if (argc > 1)
+        n = atoi(argv[1]);
+    if (argc > 2)
+        seed = atoi(argv[2]);
+    if (argc > 3)
+        first = last = atoi(argv[3]);
+    if (n < 1 || n > MAXJOBS || seed == 0)
+    {
+        printf(2, "usage: schedbench [jobs (1-%d) [seed (not 0) [policy]]]\n", MAXJOBS);
+        exit();
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        jobs[i].kind = rand() % 3;
+        jobs[i].work = 1 + rand() % MAXWORK;
+        jobs[i].arrival = rand() % 3;
+    }
+
+    // Fails, and then there is nothing to restore, in a kernel
+    // built with a single policy (make SCHED=).
+    old = setscheduler(SCHED_DEFAULT);
+    for (int pol = first; pol <= last; pol++)
+        bench(pol, n);
+    if (old >= 0)
+        setscheduler(old);
+    exit();
+}
@@ -0,0 +1,568 @@
+#include "types.h"
+#include "param.h"
+#include "mmu.h"
+#include "proc.h"
+#include "schedPolicy.h"
+#include "schedcore.h"
+
+// vruntime charged for one tick at nice 0 (CFS).
+#define CFS_VSLICE 1024
+
+// Cap on the aged burst sjfkey() adds to readyTick.  rqbefore()
+// compares keys wrap-safely, which needs them within 2^31 of each
+// other; this leaves 2^30 ticks for the readyTicks to differ by.
+#define SJF_MAXAGED (1u << 30)
+
+// Ready queues.  RUNNABLE processes live in a per-CPU binary
+// min-heap (cpu->rq) from the moment they become runnable until
+// scheduler() picks them, so a scheduling decision costs O(log n)
+// and nothing has to be re-sorted on every pass.  A process goes
+// back to the queue of the CPU it last ran on; new processes go to
+// the shortest queue, and a CPU whose queue is empty steals from
+// the longest one.
+//
+// Locking, in the kernel: every change to a queue holds that
+// queue's own lock (rqlock()).  rqenqueue() and the picknext hooks
+// take the queue locks themselves; for the other functions that
+// change a queue the caller holds its lock.  More than one queue
+// lock at a time is taken in cpu order.  stealfrom() and
+// shortestcpu() read other queues without their locks; steal()
+// checks its pick again once it holds the lock.
+
+#if HASPOLICY(SCHED_SJF) || HASPOLICY(SCHED_HBD)
+// The burst time to schedule p by.  A hint from set_burst_time()
+// wins; otherwise use the predicted burst, or the length of the
+// burst p is in the middle of if that is already longer.
+static int
+burstkey(struct proc *p)
+{
+  if (p->burstTime > 0)
+    return p->burstTime;
+  if (p->burstTicks > p->predBurst)
+    return p->burstTicks;
+  return p->predBurst;
+}
+#endif
+
+// Charge p for the ticks it has run since it was dispatched.  If p
+// is about to block, its CPU burst is over: fold it into the
+// exponential average that predicts the next one.  Blocking before
+// the quanta is used up is also what earns an interactive process
+// its way back up the MLFQ.
+void
+chargeburst(struct proc *p, int blocked)
+{
+  p->burstTicks += ticks - p->burstStart;
+  p->burstStart = ticks;
+  if (blocked)
+  {
+    p->predBurst = (BURST_ALPHA * p->burstTicks +
+                    (100 - BURST_ALPHA) * p->predBurst) / 100;
+    p->burstTicks = 0;
+    if (HASPOLICY(SCHED_MLFQ) && p->mlfqLevel > 0)
+      p->mlfqLevel--;
+  }
+}
+
+// Queue order: real-time processes first, by earliest deadline.
+// Then threads pulled in to run with their siblings (see
+// gangpull()), then lowest round, then lowest key, then FIFO.  The
+// key and round are picked by the policy when the process is
+// queued, see rqenqueue().
+static int
+rqbefore(struct proc *a, struct proc *b)
+{
+  if (!a->rtRuntime != !b->rtRuntime)
+    return a->rtRuntime != 0;
+  if (a->gangboost != b->gangboost)
+    return a->gangboost;
+  if (!a->rtRuntime && a->rqround != b->rqround)
+    return (int)(a->rqround - b->rqround) < 0;
+  if (a->rqkey != b->rqkey)
+    return (int)(a->rqkey - b->rqkey) < 0;
+  return (int)(a->rqseq - b->rqseq) < 0;
+}
+
+static void
+rqset(struct runq *rq, int i, struct proc *p)
+{
+  rq->heap[i] = p;
+  p->rqidx = i;
+}
+
+static void
+rqup(struct runq *rq, int i)
+{
+  struct proc *p = rq->heap[i];
+
+  while (i > 0 && rqbefore(p, rq->heap[(i - 1) / 2]))
+  {
+    rqset(rq, i, rq->heap[(i - 1) / 2]);
+    i = (i - 1) / 2;
+  }
+  rqset(rq, i, p);
+}
+
+void
+rqdown(struct runq *rq, int i)
+{
+  struct proc *p = rq->heap[i];
+  int c;
+
+  while ((c = 2 * i + 1) < rq->n)
+  {
+    if (c + 1 < rq->n && rqbefore(rq->heap[c + 1], rq->heap[c]))
+      c++;
+    if (!rqbefore(rq->heap[c], p))
+      break;
+    rqset(rq, i, rq->heap[c]);
+    i = c;
+  }
+  rqset(rq, i, p);
+}
+
+void
+rqpush(struct runq *rq, struct proc *p)
+{
+  if (p->rqidx >= 0)
+    panic("rqpush queued");
+  if (rq->n >= NPROC)
+    panic("rqpush full");
+  p->rqseq = rq->seq++;
+  rqset(rq, rq->n++, p);
+  rqup(rq, p->rqidx);
+}
+
+// Restore the heap order of rq after the keys of queued
+// processes have been changed in place.
+void
+rqheapify(struct runq *rq)
+{
+  int i;
+
+  for (i = rq->n / 2 - 1; i >= 0; i--)
+    rqdown(rq, i);
+}
+
+// Remove and return the first process in rq, or 0 if it is empty.
+static struct proc *
+rqpop(struct runq *rq)
+{
+  struct proc *p;
+
+  if (rq->n == 0)
+    return 0;
+  p = rq->heap[0];
+  if (--rq->n > 0)
+  {
+    rqset(rq, 0, rq->heap[rq->n]);
+    rqdown(rq, 0);
+  }
+  p->rqidx = -1;
+  return p;
+}
+
+// Take the process at index i out of the heap.
+void
+rqremove(struct runq *rq, int i)
+{
+  struct proc *p = rq->heap[i], *last;
+
+  if (--rq->n > i)
+  {
+    last = rq->heap[rq->n];
+    rqset(rq, i, last);
+    rqup(rq, i);
+    rqdown(rq, last->rqidx);
+  }
+  p->rqidx = -1;
+}
+
+// May p be moved to cpu c?  Not if its affinity mask leaves c out,
+// and real-time processes stay on the cpu they were admitted to.
+// Nor while p, having queued itself, is still switching out of its
+// cpu: only that cpu may take it until it is off its stack.
+int
+canmove(struct proc *p, struct cpu *c)
+{
+  return !p->oncpu && !p->rtRuntime && (p->affinity & (1 << (c - cpus)));
+}
+
+// The CPU in mask with the fewest waiting processes.
+static struct cpu *
+shortestcpu(uint mask)
+{
+  struct cpu *c = 0;
+  int i;
+
+  for (i = 0; i < ncpu; i++)
+    if ((mask & (1 << i)) && (c == 0 || cpus[i].rq.n < c->rq.n))
+      c = &cpus[i];
+  return c ? c : &cpus[0];
+}
+
+// Find the process c should steal: the best one c may run, from
+// the longest queue that has one.  Returns the cpu whose queue it
+// is on and sets *idx, or returns 0.
+struct cpu *
+stealfrom(struct cpu *c, int *idx)
+{
+  struct runq *rq;
+  struct cpu *best = 0;
+  int i, j, k;
+
+  for (i = 0; i < ncpu; i++)
+  {
+    rq = &cpus[i].rq;
+    if (&cpus[i] == c || (best && rq->n <= best->rq.n))
+      continue;
+    for (k = -1, j = 0; j < rq->n; j++)
+      if (canmove(rq->heap[j], c) && (k < 0 || rqbefore(rq->heap[j], rq->heap[k])))
+        k = j;
+    if (k >= 0)
+    {
+      best = &cpus[i];
+      *idx = k;
+    }
+  }
+  return best;
+}
+
+// Steal a process from a busier CPU for c.  Returns 0 if there is
+// nothing c may take, or if d's queue changed after stealfrom()
+// looked at it and the pick is gone; the caller looks again
+// before it halts.
+static struct proc *
+steal(struct cpu *c)
+{
+  struct cpu *d;
+  struct proc *p = 0;
+  int i;
+
+  if ((d = stealfrom(c, &i)) == 0)
+    return 0;
+  rqlock(d);
+  if (i < d->rq.n && canmove(d->rq.heap[i], c))
+  {
+    p = d->rq.heap[i];
+    rqremove(&d->rq, i);
+  }
+  rqunlock(d);
+  return p;
+}
+
+// Take the first process off c's own queue, or help out a busier
+// CPU if there is nothing to do here.
+static struct proc *
+rqpicknext(struct cpu *c)
+{
+  struct proc *p;
+
+  rqlock(c);
+  if ((p = rqpop(&c->rq)) != 0 && !p->rtRuntime)
+    c->rq.round = p->rqround;
+  rqunlock(c);
+  return p ? p : steal(c);
+}
+
+// Time quanta for a process in the given burst class: the largest
+// power of two not above its burst time, so that a short job gets
+// its burst done in one slice without forcing tiny slices on
+// everybody else.  Processes with no burst time get the default.
+int
+burstquantum(int burst)
+{
+  int q;
+
+  if (burst <= 0)
+    return QUANTUM_DEFAULT;
+  for (q = QUANTUM_MIN; q * 2 <= burst && q < QUANTUM_MAX; q *= 2)
+    ;
+  return q;
+}
+
+#if HASPOLICY(SCHED_CFS)
+// CFS load weight of each nice value, NICE_MIN to NICE_MAX.  Each
+// step is about 1.25x, so one nice level is worth ~10% of CPU.
+static const int niceweight[] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+    9548, 7620, 6100, 4904, 3906,
+    3121, 2501, 1991, 1586, 1277,
+    1024, 820, 655, 526, 423,
+    335, 272, 215, 172, 137,
+    110, 87, 70, 56, 45,
+    36, 29, 23, 18, 15,
+};
+#endif
+
+// Scheduling policies.  Each one decides how a process is keyed
+// on the run queue when it becomes RUNNABLE (enqueue; nextround is
+// set when it was preempted or yielded rather than woken up or
+// created), which process a CPU runs next (picknext), and whether
+// the running process has used up its time quanta on a timer tick
+// (tick).  The caller holds the queue lock for all three.  Only
+// the ones HASPOLICY() says are built in are compiled.
+
+#if HASPOLICY(SCHED_DEFAULT)
+// Default: round robin, plain FIFO, one tick each.
+static void
+rrenqueue(struct runq *rq, struct proc *p, int nextround)
+{
+  p->rqkey = 0;
+}
+
+static int
+rrtick(struct proc *p)
+{
+  return 1;
+}
+#endif
+
+// Aging for SJF and HBD: the number of ticks a process has to
+// wait to count as one tick shorter, 0 for no aging.
+int aging = AGING;
+
+#if HASPOLICY(SCHED_SJF) || HASPOLICY(SCHED_HBD)
+// Sort key for the shortest-burst policies.  With aging, the burst
+// p is ranked by drops by one every aging ticks it waits.  Every
+// queued process ages at the same rate, so ranking by the time p
+// became runnable plus its burst scaled by aging gives the same
+// order, and that key does not change while p waits.  A huge
+// set_burst_time() hint saturates instead of wrapping to the front.
+static uint
+sjfkey(struct proc *p)
+{
+  uint burst = burstkey(p);
+
+  if (aging == 0)
+    return burst;
+  if (burst > SJF_MAXAGED / aging)
+    return p->readyTick + SJF_MAXAGED;
+  return p->readyTick + burst * aging;
+}
+#endif
+
+#if HASPOLICY(SCHED_SJF)
+// SJF: shortest burst first, run until it blocks or yields.
+static void
+sjfenqueue(struct runq *rq, struct proc *p, int nextround)
+{
+  p->rqkey = sjfkey(p);
+}
+
+static int
+sjftick(struct proc *p)
+{
+  return 0;
+}
+#endif
+
+#if HASPOLICY(SCHED_HBD)
+// Hybrid: SJF order, but a process that just used up its quanta
+// waits for the next round while everything else joins the
+// current one.
+static void
+hbdenqueue(struct runq *rq, struct proc *p, int nextround)
+{
+  p->rqkey = sjfkey(p);
+  if (nextround)
+    p->rqround++;
+}
+
+static int
+hbdtick(struct proc *p)
+{
+  // Each process runs for its own quanta (see burstquantum())
+  // before going to the back of the round.
+  return p->time_slice >= p->quantum;
+}
+#endif
+
+#if HASPOLICY(SCHED_MLFQ)
+// MLFQ: FIFO within a level, higher levels first.
+static void
+mlfqenqueue(struct runq *rq, struct proc *p, int nextround)
+{
+  p->rqkey = p->mlfqLevel;
+}
+
+// Time quanta of an MLFQ level: 1, 4, 16, ... ticks, so CPU hogs
+// that sink to the bottom get long slices.
+static int
+mlfqquantum(int level)
+{
+  int q = QUANTUM_MIN << (2 * level);
+
+  return q < QUANTUM_MAX ? q : QUANTUM_MAX;
+}
+
+static int
+mlfqtick(struct proc *p)
+{
+  if (p->time_slice < mlfqquantum(p->mlfqLevel))
+    return 0;
+  // Used its whole quanta: demote it.
+  if (p->mlfqLevel < MLFQ_LEVELS - 1)
+    p->mlfqLevel++;
+  return 1;
+}
+#endif
+
+#if HASPOLICY(SCHED_CFS)
+// CFS: least vruntime first.  A process coming back from a long
+// sleep gets at most one latency period of credit, so it cannot
+// monopolise the CPU while it catches up.
+static void
+cfsenqueue(struct runq *rq, struct proc *p, int nextround)
+{
+  uint floor = rq->minvruntime - CFS_VSLICE * CFS_LATENCY;
+
+  if (!nextround && (int)(p->vruntime - floor) < 0)
+    p->vruntime = floor;
+  p->rqkey = p->vruntime;
+}
+
+static struct proc *
+cfspicknext(struct cpu *c)
+{
+  struct proc *p = rqpicknext(c);
+
+  rqlock(c);
+  if (p != 0 && !p->rtRuntime && (int)(p->vruntime - c->rq.minvruntime) > 0)
+    c->rq.minvruntime = p->vruntime;
+  rqunlock(c);
+  return p;
+}
+
+static int
+cfstick(struct proc *p)
+{
+  // Charge the tick weighted by priority, and share the latency
+  // period between everybody waiting on this CPU.
+  p->vruntime += CFS_VSLICE * niceweight[0 - NICE_MIN] /
+                 niceweight[p->nice - NICE_MIN];
+  return p->time_slice * (cpus[p->cpu].rq.n + 1) >= CFS_LATENCY;
+}
+#endif
+
+// The policies built in; the others have no name.
+const struct schedclass schedclasses[NSCHED] = {
+#if HASPOLICY(SCHED_DEFAULT)
+    [SCHED_DEFAULT] {"default", rrenqueue, rqpicknext, rrtick},
+#endif
+#if HASPOLICY(SCHED_SJF)
+    [SCHED_SJF] {"sjf", sjfenqueue, rqpicknext, sjftick},
+#endif
+#if HASPOLICY(SCHED_HBD)
+    [SCHED_HBD] {"hybrid", hbdenqueue, rqpicknext, hbdtick},
+#endif
+#if HASPOLICY(SCHED_MLFQ)
+    [SCHED_MLFQ] {"mlfq", mlfqenqueue, rqpicknext, mlfqtick},
+#endif
+#if HASPOLICY(SCHED_CFS)
+    [SCHED_CFS] {"cfs", cfsenqueue, cfspicknext, cfstick},
+#endif
+};
+
+#ifndef SCHEDONLY
+// The policy in force, see setscheduler().
+int schedpolicy = SCHEDPOLICY;
+#endif
+
+// The hooks the rest of the scheduler calls the policy through.
+// With every policy built in they go through schedclasses[]; with
+// only one, schedpolicy is a constant, so the compiler calls that
+// policy's functions directly and mostly inlines them.
+struct proc *
+picknext(struct cpu *c)
+{
+  return schedclasses[schedpolicy].picknext(c);
+}
+
+int
+policytick(struct proc *p)
+{
+  return schedclasses[schedpolicy].tick(p);
+}
+
+// Set p's queue key: its deadline if it is real-time, otherwise
+// whatever the current policy says.
+void
+setkey(struct runq *rq, struct proc *p, int nextround)
+{
+  if (p->rtRuntime)
+    p->rqkey = p->rtDeadlineAt;
+  else
+    schedclasses[schedpolicy].enqueue(rq, p, nextround);
+}
+
+// The cpu whose queue p goes on when it becomes RUNNABLE: the one
+// it last ran on, whose cache may still hold its data, unless p may
+// not run there any more.  Picking the shortest queue reads the
+// others without their locks; a stale length only makes for a
+// worse pick.
+struct cpu *
+rqhome(struct proc *p)
+{
+  if (p->cpu >= 0 && (p->affinity & (1 << p->cpu)))
+    return &cpus[p->cpu];
+  return shortestcpu(p->affinity);
+}
+
+// Put p, which has just become RUNNABLE, on a ready queue keyed by
+// the current policy, that of rqhome(p).  Returns the cpu whose
+// queue p is on.
+struct cpu *
+rqenqueue(struct proc *p, int nextround)
+{
+  struct cpu *c = rqhome(p);
+
+  rqenqueueon(p, c, nextround);
+  return c;
+}
+
+// Put p on c's ready queue.
+void
+rqenqueueon(struct proc *p, struct cpu *c, int nextround)
+{
+  rqlock(c);
+  p->readyTick = ticks;
+  p->rqround = c->rq.round;
+  p->rqcpu = c - cpus;
+  setkey(&c->rq, p, nextround);
+  rqpush(&c->rq, p);
+  rqunlock(c);
+}
+
+// p, just picked, starts running on c with slice ticks of its time
+// quanta already used.  Charge the wait that is now over.
+void
+dispatch(struct proc *p, struct cpu *c, int slice)
+{
+  if (p->cpu >= 0 && p->cpu != c - cpus)
+    p->migrations++;
+  p->cpu = c - cpus;
+  p->gangboost = 0;
+  p->state = RUNNING;
+  p->time_slice = slice;
+  if (!p->alreadyRun)
+  {
+    p->alreadyRun = 1;
+    p->firstRun = ticks;
+  }
+  p->burstStart = ticks;
+  p->waitTicks += ticks - p->readyTick;
+  if (ticks - p->readyTick > p->maxWait)
+    p->maxWait = ticks - p->readyTick;
+}
+
+// MLFQ priority boost of one process: back to the top level.  The
+// caller restores the heap order of the queues afterwards.
+void
+mlfqraise(struct proc *p)
+{
+  p->mlfqLevel = 0;
+  if (p->rqidx >= 0 && !p->rtRuntime)
+    p->rqkey = 0;
+}
@@ -0,0 +1,51 @@
+// Run queues and scheduling policies (schedcore.c).  Only the
+// scheduling decisions live there, no locking, sleeping or context
+// switching, so the same code builds into the kernel, where proc.c
+// calls it, and into the host simulator schedsim.  See schedcore.c
+// for which queue locks are held.
+// Include after types.h, param.h, mmu.h and proc.h.
+
+struct schedclass
+{
+  char *name;
+  void (*enqueue)(struct runq *, struct proc *, int);
+  struct proc *(*picknext)(struct cpu *);
+  int (*tick)(struct proc *);
+};
+
+// Policies built in.  "make SCHED=hbd" and so on defines SCHEDONLY
+// to build just the one; by default all of them are there and
+// setscheduler() switches between them.
+#ifdef SCHEDONLY
+#define HASPOLICY(n) ((n) == SCHEDONLY)
+#define schedpolicy SCHEDONLY // the one policy, never changes
+#else
+#define HASPOLICY(n) 1
+extern int schedpolicy; // the policy in force, see setscheduler()
+#endif
+
+// Supplied by the kernel, or by the simulator.
+extern uint ticks;
+void panic(char *) __attribute__((noreturn));
+void rqlock(struct cpu *);
+void rqunlock(struct cpu *);
+
+// schedcore.c
+extern const struct schedclass schedclasses[NSCHED];
+extern int aging;
+struct proc *picknext(struct cpu *);
+int policytick(struct proc *);
+void chargeburst(struct proc *, int);
+int burstquantum(int);
+void rqpush(struct runq *, struct proc *);
+void rqdown(struct runq *, int);
+void rqremove(struct runq *, int);
+void rqheapify(struct runq *);
+int canmove(struct proc *, struct cpu *);
+struct cpu *stealfrom(struct cpu *, int *);
+void setkey(struct runq *, struct proc *, int);
+struct cpu *rqhome(struct proc *);
+struct cpu *rqenqueue(struct proc *, int);
+void rqenqueueon(struct proc *, struct cpu *, int);
+void dispatch(struct proc *, struct cpu *, int);
+void mlfqraise(struct proc *);
@@ -0,0 +1,475 @@
+// Host-side scheduler simulator.  Replays a trace of jobs through
+// the kernel's own run queues and policies (schedcore.c) on
+// simulated cpus, one timer tick at a time, and prints the same
+// key=value line per policy as schedbench does.  Build it on the
+// host with "make schedsim" and run
+//     schedsim [-p policy] [-c cpus] [-a aging] [-n jobs] [-s seed] [trace]
+// policy is a name or SCHED_ number, all of them if not given.  A
+// trace file ("-" for stdin) has one job per line, in order of
+// arrival: the tick it arrives at, then the ticks of cpu it needs
+// and of sleep in between, alternately,
+//     arrival cpu [sleep cpu]...
+// Without a trace, the jobs are made up from the seed the same way
+// schedbench makes them up, so both runs can be compared.
+//
+// Like the kernel, at most NPROC jobs exist at once; a job that
+// arrives when the table is full is started when a slot frees up,
+// and that delay counts towards its turnaround and response time.
+// Real-time processes, gang scheduling and yield_to() are not
+// simulated.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "types.h"
+#include "param.h"
+#include "mmu.h"
+#include "proc.h"
+#include "schedPolicy.h"
+#include "schedcore.h"
+
+#define MAXWORK 40 // as in schedbench
+
+struct job {
+  uint arrival;
+  int nphase;  // cpu, sleep, cpu, ... sleep, cpu: always odd
+  int *phase;
+};
+
+struct job *jobs;
+int njobs;
+
+// What the kernel shares with schedcore.c.
+uint ticks;
+struct cpu cpus[NCPU];
+int ncpu = 1;
+
+struct proc procs[NPROC];
+int jobof[NPROC];  // job a proc is running
+int phaseof[NPROC];  // phase of that job it is in
+int left[NPROC];  // ticks of cpu left in the phase
+int nlive;
+struct proc *freeprocs[NPROC];
+int nfree;
+// Proc each cpu just preempted.  Like sched(), count a switch for
+// it only if the cpu then runs something else or goes idle.
+struct proc *preempted[NCPU];
+
+// Procs sleeping, a binary min-heap by the tick they wake up at.
+struct proc *sleepers[NPROC];
+int nsleep;
+
+int *turnaround, *waiting, *response;
+long long switches;
+int done;
+
+void
+panic(char *s)
+{
+  fprintf(stderr, "schedsim: panic: %s\n", s);
+  exit(1);
+}
+
+// One simulated cpu runs at a time, so the queues need no locks.
+void
+rqlock(struct cpu *c)
+{
+}
+
+void
+rqunlock(struct cpu *c)
+{
+}
+
+void
+die(char *s)
+{
+  fprintf(stderr, "schedsim: %s\n", s);
+  exit(1);
+}
+
+void*
+xmalloc(size_t n)
+{
+  void *v;
+
+  if((v = malloc(n)) == 0)
+    die("out of memory");
+  return v;
+}
+
+// Same generator and same draws as schedbench.
+uint seed = 1;
+
+uint
+rnd(void)
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
+
+void
+makejobs(int n)
+{
+  uint t = 0;
+  int i, j, kind, work, *ph;
+
+  jobs = xmalloc(n * sizeof(struct job));
+  for(i = 0; i < n; i++){
+    kind = rnd() % 3;
+    work = 1 + rnd() % MAXWORK;
+    t += rnd() % 3;
+    ph = xmalloc((2 * work + 1) * sizeof(int));
+    jobs[i].arrival = t;
+    jobs[i].phase = ph;
+    if(kind == 0){
+      // CPU bound: spin for work ticks.
+      ph[0] = work;
+      jobs[i].nphase = 1;
+    } else if(kind == 1){
+      // I/O bound: sleep a tick, work times.
+      for(j = 0; j < work; j++){
+        ph[2 * j] = 0;
+        ph[2 * j + 1] = 1;
+      }
+      ph[2 * work] = 0;
+      jobs[i].nphase = 2 * work + 1;
+    } else {
+      // Mixed: two ticks of cpu, then a tick of sleep.
+      for(j = 0; 2 * j < work; j++){
+        ph[2 * j] = 2;
+        ph[2 * j + 1] = 1;
+      }
+      ph[2 * j] = 0;
+      jobs[i].nphase = 2 * j + 1;
+    }
+  }
+  njobs = n;
+}
+
+void
+readjobs(FILE *f)
+{
+  char line[4096], *s, *e;
+  int cap = 0, n, v[sizeof(line) / 2 + 2];
+  long x;
+
+  while(fgets(line, sizeof(line), f)){
+    if(strchr(line, '\n') == 0 && !feof(f))
+      die("trace line too long");
+    for(n = 0, s = line; ; s = e){
+      x = strtol(s, &e, 10);
+      if(e == s)
+        break;
+      if(x < 0)
+        die("negative time in trace");
+      v[n++] = x;
+    }
+    if(n == 0)
+      continue;
+    if(njobs > 0 && (uint)v[0] < jobs[njobs-1].arrival)
+      die("trace is not in order of arrival");
+    if(njobs == cap){
+      cap = cap ? 2 * cap : 1024;
+      if((jobs = realloc(jobs, cap * sizeof(struct job))) == 0)
+        die("out of memory");
+    }
+    if(n % 2 == 1)
+      v[n++] = 0;  // ends with a sleep: exit when it wakes
+    jobs[njobs].arrival = v[0];
+    jobs[njobs].nphase = n - 1;
+    jobs[njobs].phase = xmalloc((n - 1) * sizeof(int));
+    memmove(jobs[njobs].phase, v + 1, (n - 1) * sizeof(int));
+    njobs++;
+  }
+}
+
+void
+sleeppush(struct proc *p)
+{
+  int i = nsleep++;
+
+  while(i > 0 && sleepers[(i-1)/2]->wakeTick > p->wakeTick){
+    sleepers[i] = sleepers[(i-1)/2];
+    i = (i-1)/2;
+  }
+  sleepers[i] = p;
+}
+
+struct proc*
+sleeppop(void)
+{
+  struct proc *p = sleepers[0], *last = sleepers[--nsleep];
+  int i = 0, c;
+
+  while((c = 2*i + 1) < nsleep){
+    if(c + 1 < nsleep && sleepers[c+1]->wakeTick < sleepers[c]->wakeTick)
+      c++;
+    if(sleepers[c]->wakeTick >= last->wakeTick)
+      break;
+    sleepers[i] = sleepers[c];
+    i = c;
+  }
+  sleepers[i] = last;
+  return p;
+}
+
+// Make p RUNNABLE, as makerunnable() does.
+void
+ready(struct proc *p, int nextround)
+{
+  p->state = RUNNABLE;
+  rqenqueue(p, nextround);
+}
+
+// Start job j in a free slot, as fork() does.
+void
+start(int j)
+{
+  struct proc *p = freeprocs[--nfree];
+
+  memset(p, 0, sizeof(*p));
+  p->state = EMBRYO;
+  p->pid = j + 1;
+  p->quantum = QUANTUM_DEFAULT;
+  p->rqidx = -1;
+  p->cpu = -1;
+  p->affinity = ~0;
+  p->ctime = jobs[j].arrival;
+  jobof[p - procs] = j;
+  phaseof[p - procs] = 0;
+  left[p - procs] = jobs[j].phase[0];
+  nlive++;
+  ready(p, 0);
+}
+
+// p's cpu phase is over: sleep through the next phase, or exit if
+// there is none.
+void
+block(struct proc *p)
+{
+  int i = p - procs, d;
+  struct job *j = &jobs[jobof[i]];
+
+  p->nvcsw++;
+  p->numContextSwitches++;
+  chargeburst(p, 1);
+  if(phaseof[i] + 1 >= j->nphase){
+    turnaround[done] = ticks - p->ctime;
+    waiting[done] = p->waitTicks;
+    response[done] = p->firstRun - p->ctime;
+    switches += p->numContextSwitches;
+    done++;
+    p->state = UNUSED;
+    freeprocs[nfree++] = p;
+    nlive--;
+    return;
+  }
+  d = j->phase[phaseof[i] + 1];
+  phaseof[i] += 2;
+  left[i] = j->phase[phaseof[i]];
+  p->state = SLEEPING;
+  p->wakeTick = ticks + d;
+  sleeppush(p);
+}
+
+// The periodic MLFQ boost, as mlfqboost() does it.
+void
+boost(void)
+{
+  struct proc *p;
+  int i;
+
+  if(schedpolicy != SCHED_MLFQ)
+    return;
+  for(p = procs; p < procs + NPROC; p++)
+    if(p->state != UNUSED)
+      mlfqraise(p);
+  for(i = 0; i < ncpu; i++)
+    rqheapify(&cpus[i].rq);
+}
+
+int
+cmpint(const void *a, const void *b)
+{
+  return *(int*)a - *(int*)b;
+}
+
+// Print key_mean, key_p50 and key_p99 of a[0..n-1], sorting it.
+void
+stats(char *key, int *a, int n)
+{
+  long long sum = 0;
+  int i;
+
+  qsort(a, n, sizeof(int), cmpint);
+  for(i = 0; i < n; i++)
+    sum += a[i];
+  printf(" %s_mean=%lld %s_p50=%d %s_p99=%d", key, sum / n,
+         key, a[(n - 1) / 2], key, a[(99LL * n + 99) / 100 - 1]);
+}
+
+void
+simulate(int pol)
+{
+  struct cpu *c;
+  struct proc *p;
+  int next = 0, busy;
+  uint t, old;
+
+  memset(cpus, 0, sizeof(cpus));
+  memset(procs, 0, sizeof(procs));
+  memset(preempted, 0, sizeof(preempted));
+  nlive = nsleep = done = 0;
+  for(nfree = 0; nfree < NPROC; nfree++)
+    freeprocs[nfree] = &procs[NPROC - 1 - nfree];
+  switches = 0;
+  schedpolicy = pol;
+  ticks = jobs[0].arrival;
+
+  for(;;){
+    // Arrivals and wakeups due by now.
+    while(next < njobs && jobs[next].arrival <= ticks && nlive < NPROC)
+      start(next++);
+    while(nsleep > 0 && sleepers[0]->wakeTick <= ticks)
+      ready(sleeppop(), 0);
+
+    // Every idle cpu picks something to run, as scheduler() does.
+    busy = 0;
+    for(c = cpus; c < cpus + ncpu; c++){
+      while(c->proc == 0 && (p = picknext(c)) != 0){
+        if(preempted[c - cpus] && preempted[c - cpus] != p)
+          preempted[c - cpus]->numContextSwitches++;
+        preempted[c - cpus] = 0;
+        dispatch(p, c, 0);
+        c->proc = p;
+        if(left[p - procs] == 0){
+          c->proc = 0;
+          block(p);
+        }
+      }
+      if(preempted[c - cpus]){
+        preempted[c - cpus]->numContextSwitches++;
+        preempted[c - cpus] = 0;
+      }
+      busy |= c->proc != 0;
+    }
+    if(done == njobs)
+      break;
+
+    // Nothing running: skip ahead to the next arrival or wakeup.
+    t = ticks + 1;
+    if(!busy){
+      t = ~0;
+      if(next < njobs && nlive < NPROC)
+        t = jobs[next].arrival;
+      if(nsleep > 0 && sleepers[0]->wakeTick < t)
+        t = sleepers[0]->wakeTick;
+      if(t == ~0)
+        panic("stuck");
+    }
+    old = ticks;
+    ticks = t;
+    if(ticks / MLFQ_BOOST != old / MLFQ_BOOST)
+      boost();
+
+    // The timer tick ends a tick of work for every running
+    // process: it finishes its burst, or the policy may preempt
+    // it, as schedtick() and yield() do.
+    for(c = cpus; c < cpus + ncpu; c++){
+      if((p = c->proc) == 0)
+        continue;
+      p->time_slice++;
+      if(--left[p - procs] == 0){
+        c->proc = 0;
+        block(p);
+      } else if(policytick(p)){
+        c->proc = 0;
+        p->nivcsw++;
+        preempted[c - cpus] = p;
+        chargeburst(p, 0);
+        ready(p, 1);
+      }
+    }
+  }
+
+  t = ticks - jobs[0].arrival;
+  if(t == 0)
+    t = 1;
+  printf("policy=%s jobs=%d ticks=%u throughput=%lld", schedclasses[pol].name, done,
+         t, done * 1000LL / t);
+  stats("turnaround", turnaround, done);
+  stats("wait", waiting, done);
+  stats("response", response, done);
+  printf(" switches=%lld\n", switches);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int c, n = 20, first = 0, last = NSCHED - 1;
+  FILE *f;
+
+  while((c = getopt(argc, argv, "p:c:a:n:s:")) != -1){
+    switch(c){
+    case 'p':
+      for(first = 0; first < NSCHED; first++)
+        if(strcmp(optarg, schedclasses[first].name) == 0)
+          break;
+      if(first == NSCHED)
+        first = atoi(optarg);
+      if(first < 0 || first >= NSCHED)
+        die("no such policy");
+      last = first;
+      break;
+    case 'c':
+      ncpu = atoi(optarg);
+      if(ncpu < 1 || ncpu > NCPU)
+        die("cpus out of range");
+      break;
+    case 'a':
+      aging = atoi(optarg);
+      if(aging < 0)
+        die("aging must not be negative");
+      break;
+    case 'n':
+      n = atoi(optarg);
+      if(n < 1)
+        die("jobs must be positive");
+      break;
+    case 's':
+      seed = strtoul(optarg, 0, 10);
+      if(seed == 0)
+        die("seed must not be 0");
+      break;
+    default:
+      fprintf(stderr, "usage: schedsim [-p policy] [-c cpus] [-a aging] "
+              "[-n jobs] [-s seed] [trace]\n");
+      exit(1);
+    }
+  }
+
+  if(optind < argc){
+    if(strcmp(argv[optind], "-") == 0)
+      f = stdin;
+    else if((f = fopen(argv[optind], "r")) == 0){
+      perror(argv[optind]);
+      exit(1);
+    }
+    readjobs(f);
+    if(njobs == 0)
+      die("empty trace");
+  } else
+    makejobs(n);
+
+  turnaround = xmalloc(njobs * sizeof(int));
+  waiting = xmalloc(njobs * sizeof(int));
+  response = xmalloc(njobs * sizeof(int));
+  for(c = first; c <= last; c++)
+    simulate(c);
+  return 0;
+}
@@ -0,0 +1,55 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "schedStats.h"
+
+// Wakeups caused by sleep().  SLEEPERS children sleep for a long
+// time while the parent measures TICKS ticks.  Sleeping processes
+// should only be woken when their own timeout expires, so the
+// number of processes woken stays close to zero instead of growing
+// by SLEEPERS every tick.
+//     sleeptest [sleepers] [ticks]
+
+int main(int argc, char *argv[])
+{
+    int sleepers = 20, nticks = 100;
+    struct schedStats before, after;
+    int pids[64];
+
+    if (argc > 1)
+        sleepers = atoi(argv[1]);
+    if (argc > 2)
+        nticks = atoi(argv[2]);
+    if (sleepers > 64)
+        sleepers = 64;
+
+    for (int i = 0; i < sleepers; i++)
+    {
+        if ((pids[i] = fork()) < 0)
+        {
+            printf(1, "fork failed after %d sleepers\n", i);
+            sleepers = i;
+            break;
+        }
+        if (pids[i] == 0)
+        {
+            sleep(100000);
+            exit();
+        }
+    }
+
+    // Let the children get to sleep.
+    sleep(5);
+    getschedstats(&before);
+    sleep(nticks);
+    getschedstats(&after);
+
+    for (int i = 0; i < sleepers; i++)
+        kill(pids[i]);
+    while (wait() != -1)
+        ;
+
+    printf(1, "sleepers %d  ticks %d  woken %d  wakeups %d\n", sleepers, nticks,
+           after.woken - before.woken, after.wakeups - before.wakeups);
+    exit();
+}
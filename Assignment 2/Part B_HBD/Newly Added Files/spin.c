@@ -0,0 +1,17 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// CPU-bound busy work for the scheduler tests, linked into every
+// user program (see ULIB in the Makefile) so that a unit of spin()
+// costs the same in all of them.  One unit is a fraction of a tick
+// under qemu; rttest calibrates it against uptime().
+
+volatile int spinsink;
+
+void spin(int n)
+{
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < 100000; j++)
+            spinsink += j;
+}
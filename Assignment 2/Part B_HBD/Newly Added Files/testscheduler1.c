@@ -3,6 +3,9 @@
 #include "user.h"
 
 #include "processInfo.h"
+#include "schedPolicy.h"
+
+char *policies[NSCHED] = {"default", "sjf", "hybrid", "mlfq", "cfs"};
 
 void cpubounddelay(int val)
 {
@@ -25,152 +28,110 @@ void iobounddelay(int val)
         sleep(1);
     }
 }
-int main()
+
+// Run one workload of 10 children with burst times t[], even
+// children CPU bound and odd ones IO bound.  The usage waitinfo()
+// reports for each child gives the context switches, turnaround
+// and waiting time to compare the schedulers by.
+void runtest(int testno, int t[10])
 {
-    {
+    int n = 0, switches = 0, turnaround = 0, waiting = 0, maxwait = 0;
+    struct processInfo r;
 
-        printf(1, "---------------------------Test 1 --------------------------------------\n");
-        printf(1, "Process Type      Burst Time      Context Switches       PID\n");
-        // array containing burst times
-        int t[10] = {40, 70, 10, 90, 60, 30, 20, 80, 100, 50};
-        long x = 0;
-        // set_burst_time(1);
+    printf(1, "\n---------------------------Test %d --------------------------------------\n", testno);
+    printf(1, "Process Type      Burst Time      Context Switches      PID\n");
 
-        for (int i = 0; i < 10; i++)
+    for (int i = 0; i < 10; i++)
+    {
+        if (fork() == 0)
         {
-            if (fork() == 0)
+            long x = 0;
+
+            x = set_burst_time(t[i]);
+
+            if (x < 0)
             {
-                // printf(1,"child %d",i);
-                x = set_burst_time(t[i]);
-
-                if (x < 0)
-                {
-                    printf(1, "Counldn't set burst time for process %d\n", getpid());
-                }
-
-                // CPU bound process
-                if (i % 2 == 0)
-                {
-                    cpubounddelay(t[i]);
-
-                    printf(1, "CPU Bound  ");
-                }
-
-                // IO bound process
-                else
-                {
-                    // mimicking IO wait
-                    iobounddelay(t[i]);
-                    printf(1, "IO Bound   ");
-                }
-
-                x = get_burst_time();
-                struct processInfo *info;
-                info = (struct processInfo *)malloc(sizeof(struct processInfo));
-                getProcInfoStruct(getpid(), info);
-                printf(1, "            %d               %d                %d\n", x, info->numberContextSwitches, getpid());
-                exit();
+                printf(1, "Counldn't set burst time for process %d\n", getpid());
             }
-        }
 
-        while (wait() != -1)
-            ;
-    }
-    {
-        printf(1, "\n---------------------------Test 2 --------------------------------------\n");
-        printf(1, "Process Type      Burst Time      Context Switches      PID\n");
-        // array containing burst times
-        int t[10] = {30, 29, 28, 27, 26, 25, 24, 23, 22, 21};
-        long x = 0;
-        // set_burst_time(1);
-
-        for (int i = 0; i < 10; i++)
-        {
-            if (fork() == 0)
+            // CPU bound process
+            if (i % 2 == 0)
             {
-                // printf(1,"child %d",i);
-                x = set_burst_time(t[i]);
-
-                if (x < 0)
-                {
-                    printf(1, "Counldn't set burst time for process %d\n", getpid());
-                }
-
-                // CPU bound process
-                if (i % 2 == 0)
-                {
-                    cpubounddelay(t[i]);
-
-                    printf(1, "CPU Bound  ");
-                }
-
-                // IO bound process
-                else
-                {
-                    // mimicking IO wait
-                    iobounddelay(t[i]);
-                    printf(1, "IO Bound   ");
-                }
-
-                x = get_burst_time();
-                struct processInfo *info;
-                info = (struct processInfo *)malloc(sizeof(struct processInfo));
-                getProcInfoStruct(getpid(), info);
-                printf(1, "            %d               %d                %d\n", x, info->numberContextSwitches, getpid());
-                exit();
+                cpubounddelay(t[i]);
+
+                printf(1, "CPU Bound  ");
             }
+
+            // IO bound process
+            else
+            {
+                // mimicking IO wait
+                iobounddelay(t[i]);
+                printf(1, "IO Bound   ");
+            }
+
+            x = get_burst_time();
+            struct processInfo *info;
+            info = (struct processInfo *)malloc(sizeof(struct processInfo));
+            getProcInfoStruct(getpid(), info);
+            printf(1, "            %d               %d                %d\n", x, info->numberContextSwitches, getpid());
+            exit();
         }
+    }
 
-        while (wait() != -1)
-            ;
+    while (waitinfo(&r) != -1)
+    {
+        switches += r.numberContextSwitches;
+        turnaround += r.exitTime - r.creationTime;
+        waiting += r.waitTicks;
+        if (r.maxWaitTicks > maxwait)
+            maxwait = r.maxWaitTicks;
+        n++;
     }
+    printf(1, "Total context switches: %d\n", switches);
+    printf(1, "Average turnaround: %d ticks\n", n ? turnaround / n : 0);
+    printf(1, "Average waiting: %d ticks\n", n ? waiting / n : 0);
+    printf(1, "Longest wait: %d ticks\n", maxwait);
+}
+
+// Usage: testscheduler1 [policy [aging]]
+// Runs the same workloads under the given policy (a SCHED_ number),
+// or under every policy in turn when none is given.  aging sets the
+// SJF/HBD aging rate for the run, 0 turning it off.
+int main(int argc, char *argv[])
+{
+    // arrays containing burst times
+    int t1[10] = {40, 70, 10, 90, 60, 30, 20, 80, 100, 50};
+    int t2[10] = {30, 29, 28, 27, 26, 25, 24, 23, 22, 21};
+    int t3[10] = {30, 28, 28, 28, 26, 25, 22, 22, 22, 22};
+    int first = 0, last = NSCHED - 1;
+    int old = -1, oldaging = -1;
+
+    if (argc > 1)
+        first = last = atoi(argv[1]);
+    if (argc > 2)
+        oldaging = setaging(atoi(argv[2]));
+
+    for (int pol = first; pol <= last; pol++)
     {
-        printf(1, "\n---------------------------Test 3 --------------------------------------\n");
-        printf(1, "Process Type      Burst Time      Context Switches      PID\n");
-        // array containing burst times
-        int t[10] = {30, 28, 28, 28, 26, 25, 22, 22, 22, 22};
-        long x = 0;
-        // set_burst_time(1);
-
-        for (int i = 0; i < 10; i++)
+        int prev = setscheduler(pol);
+        if (prev < 0)
         {
-            if (fork() == 0)
-            {
-                // printf(1,"child %d",i);
-                x = set_burst_time(t[i]);
-
-                if (x < 0)
-                {
-                    printf(1, "Counldn't set burst time for process %d\n", getpid());
-                }
-
-                // CPU bound process
-                if (i % 2 == 0)
-                {
-                    cpubounddelay(t[i]);
-
-                    printf(1, "CPU Bound  ");
-                }
-
-                // IO bound process
-                else
-                {
-                    // mimicking IO wait
-                    iobounddelay(t[i]);
-                    printf(1, "IO Bound   ");
-                }
-
-                x = get_burst_time();
-                struct processInfo *info;
-                info = (struct processInfo *)malloc(sizeof(struct processInfo));
-                getProcInfoStruct(getpid(), info);
-                printf(1, "            %d               %d                %d\n", x, info->numberContextSwitches, getpid());
-                exit();
-            }
+            // Not built in, see make SCHED=.
+            printf(1, "No scheduling policy %d\n", pol);
+            continue;
         }
+        if (old < 0)
+            old = prev;
 
-        while (wait() != -1)
-            ;
+        printf(1, "\n=========================== Policy: %s ===========================\n", policies[pol]);
+        runtest(1, t1);
+        runtest(2, t2);
+        runtest(3, t3);
     }
+    if (old >= 0)
+        setscheduler(old);
+    if (oldaging >= 0)
+        setaging(oldaging);
     exit();
-}
\ No newline at end of file
+}
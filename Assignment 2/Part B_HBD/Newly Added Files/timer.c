@@ -0,0 +1,121 @@
+// Kernel timers, kept in a two-level timer wheel so that the
+// timer interrupt only looks at timers that are about to expire.
+//
+// Level 0 has one slot for each of the next TW_SIZE ticks.  Level 1
+// has one slot for each later run of TW_SIZE ticks, up to
+// TW_SIZE*TW_SIZE ticks ahead; each time level 0 wraps around, the
+// next level 1 slot is spread out over it.  Timers further away than
+// that wait on a far list that is re-filed once per level 1 lap.
+//
+// Everything here is protected by tickslock.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "spinlock.h"
+#include "timer.h"
+
+#define TW_BITS 6
+#define TW_SIZE (1 << TW_BITS)
+#define TW_MASK (TW_SIZE - 1)
+
+static struct timer *wheel0[TW_SIZE];
+static struct timer *wheel1[TW_SIZE];
+static struct timer *far;
+
+static void
+link(struct timer **head, struct timer *t)
+{
+  t->next = *head;
+  if (t->next)
+    t->next->pprev = &t->next;
+  *head = t;
+  t->pprev = head;
+}
+
+static void
+unlink(struct timer *t)
+{
+  *t->pprev = t->next;
+  if (t->next)
+    t->next->pprev = t->pprev;
+  t->next = 0;
+  t->pprev = 0;
+}
+
+// File t in the slot it belongs to as of now.
+static void
+enqueue(struct timer *t)
+{
+  uint delta = t->expires - ticks;
+
+  if (delta < TW_SIZE)
+    link(&wheel0[t->expires & TW_MASK], t);
+  else if (delta < TW_SIZE * TW_SIZE)
+    link(&wheel1[(t->expires >> TW_BITS) & TW_MASK], t);
+  else
+    link(&far, t);
+}
+
+// Move every timer on list *head back through enqueue().
+static void
+cascade(struct timer **head)
+{
+  struct timer *t, *next;
+
+  t = *head;
+  *head = 0;
+  for (; t; t = next)
+  {
+    next = t->next;
+    t->pprev = 0;
+    enqueue(t);
+  }
+}
+
+// Call fn(arg) from the timer interrupt once ticks reaches expires.
+// t must not be pending already.
+void settimer(struct timer *t, uint expires, void (*fn)(void *), void *arg)
+{
+  if (!holding(&tickslock))
+    panic("settimer");
+  if (t->pprev)
+    panic("settimer pending");
+  // This tick's timers have run already; a deadline that has
+  // passed goes off on the next one.
+  if ((int)(expires - ticks) <= 0)
+    expires = ticks + 1;
+  t->expires = expires;
+  t->fn = fn;
+  t->arg = arg;
+  enqueue(t);
+}
+
+// Cancel t if it has not run yet.
+void deltimer(struct timer *t)
+{
+  if (!holding(&tickslock))
+    panic("deltimer");
+  if (t->pprev)
+    unlink(t);
+}
+
+// Run the timers due at the current tick.  Called by the timer
+// interrupt after advancing ticks.
+void runtimers(void)
+{
+  struct timer *t;
+  uint slot = ticks & TW_MASK;
+
+  if (slot == 0)
+  {
+    if (((ticks >> TW_BITS) & TW_MASK) == 0)
+      cascade(&far);
+    cascade(&wheel1[(ticks >> TW_BITS) & TW_MASK]);
+  }
+  while ((t = wheel0[slot]) != 0)
+  {
+    unlink(t);
+    t->fn(t->arg);
+  }
+}
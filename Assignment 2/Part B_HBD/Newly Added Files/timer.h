@@ -0,0 +1,9 @@
+// Kernel timer, see timer.c.
+struct timer
+{
+  uint expires;          // value of ticks at which fn runs
+  void (*fn)(void *);    // called with tickslock held
+  void *arg;
+  struct timer *next;    // in its wheel slot
+  struct timer **pprev;  // link pointing at us, 0 if not pending
+};
@@ -0,0 +1,12 @@
+// One process as reported by getprocs().
+struct uproc
+{
+    int pid;
+    int ppid;
+    int state; // enum procstate, see proc.h
+    int sz;
+    int burstTime;
+    int switches; // context switches
+    int ticks;    // timer ticks run, user and kernel
+    char name[16];
+};
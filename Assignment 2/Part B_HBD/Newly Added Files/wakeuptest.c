@@ -0,0 +1,86 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "schedStats.h"
+
+// Cost of wakeup() with many sleepers.  SLEEPERS children block on
+// pipes that are never written, then the parent and one more child
+// play ping-pong over a pair of pipes.  Each round trip is two
+// wakeups; with hashed wait channels each one should look at about
+// one sleeping process, not at all of them.
+//     wakeuptest [sleepers] [rounds]
+
+int main(int argc, char *argv[])
+{
+    int sleepers = 40, rounds = 1000;
+    int idle[2], ping[2], pong[2];
+    struct schedStats before, after;
+    int pid, start, elapsed, wakeups, run;
+    char c = 0;
+
+    if (argc > 1)
+        sleepers = atoi(argv[1]);
+    if (argc > 2)
+        rounds = atoi(argv[2]);
+
+    if (pipe(idle) < 0 || pipe(ping) < 0 || pipe(pong) < 0)
+    {
+        printf(1, "pipe failed\n");
+        exit();
+    }
+
+    for (int i = 0; i < sleepers; i++)
+    {
+        if ((pid = fork()) < 0)
+        {
+            printf(1, "fork failed after %d sleepers\n", i);
+            sleepers = i;
+            break;
+        }
+        if (pid == 0)
+        {
+            close(idle[1]);
+            read(idle[0], &c, 1);
+            exit();
+        }
+    }
+
+    if (fork() == 0)
+    {
+        for (int i = 0; i < rounds; i++)
+        {
+            read(ping[0], &c, 1);
+            write(pong[1], &c, 1);
+        }
+        exit();
+    }
+
+    getschedstats(&before);
+    start = uptime();
+    for (int i = 0; i < rounds; i++)
+    {
+        write(ping[1], &c, 1);
+        read(pong[0], &c, 1);
+    }
+    elapsed = uptime() - start;
+    getschedstats(&after);
+
+    // Closing the write end wakes every sleeper with end of file.
+    close(idle[1]);
+    while (wait() != -1)
+        ;
+
+    wakeups = after.wakeups - before.wakeups;
+    run = after.wokenRun - before.wokenRun;
+    printf(1, "sleepers %d  rounds %d  ticks %d\n", sleepers, rounds, elapsed);
+    printf(1, "wakeups %d  woken %d  scanned %d\n", wakeups,
+           after.woken - before.woken, after.scanned - before.scanned);
+    if (wakeups > 0)
+        printf(1, "scanned per wakeup %d.%d\n",
+               (after.scanned - before.scanned) / wakeups,
+               (after.scanned - before.scanned) * 10 / wakeups % 10);
+    if (run > 0)
+        printf(1, "wakeup latency %d ticks over %d dispatches\n",
+               after.wakeLatency - before.wakeLatency, run);
+    exit();
+}